@@ -0,0 +1,321 @@
+#include <stdlib.h>
+#include <string.h>
+#include "vec_alloc.h"
+
+#define ALIGNMENT 16
+#define ALIGN_UP(x) (((x) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+
+/*
+ * bump arena
+ */
+
+#define BLOCK_HEADER ALIGN_UP(sizeof(vec_arena_block_t))
+
+static unsigned char * block_data(vec_arena_block_t * block) {
+    return (unsigned char *)block + BLOCK_HEADER;
+}
+
+static void * arena_alloc(void * ctx, size_t size) {
+    vec_arena_t * arena = ctx;
+    vec_arena_block_t * block = arena->blocks;
+    size_t block_size;
+    void * ptr;
+
+    size = ALIGN_UP(size > 0 ? size : 1);
+
+    //start a new block when the current one is full
+    if (block == NULL || block->size - block->used < size) {
+        block_size = size > arena->block_size ? size : arena->block_size;
+        block = malloc(BLOCK_HEADER + block_size);
+        if (block == NULL)
+            return NULL;
+
+        block->size = block_size;
+        block->used = 0;
+        block->last = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    ptr = block_data(block) + block->used;
+    block->last = block->used;
+    block->used += size;
+
+    return ptr;
+}
+
+static void arena_free(void * ctx, void * ptr, size_t size) {
+    vec_arena_t * arena = ctx;
+    vec_arena_block_t * block = arena->blocks;
+    (void)size;
+
+    //only the most recent allocation can be handed back, the rest waits for reset
+    if (block != NULL && ptr == block_data(block) + block->last)
+        block->used = block->last;
+}
+
+static void * arena_realloc(void * ctx, void * ptr, size_t old_size, size_t new_size) {
+    vec_arena_t * arena = ctx;
+    vec_arena_block_t * block = arena->blocks;
+    void * tmp;
+
+    if (ptr == NULL)
+        return arena_alloc(ctx, new_size);
+
+    //the most recent allocation can grow or shrink in place
+    if (block != NULL && ptr == block_data(block) + block->last
+            && block->size - block->last >= ALIGN_UP(new_size)) {
+        block->used = block->last + ALIGN_UP(new_size > 0 ? new_size : 1);
+        return ptr;
+    }
+
+    tmp = arena_alloc(ctx, new_size);
+    if (tmp == NULL)
+        return NULL;
+
+    memcpy(tmp, ptr, old_size < new_size ? old_size : new_size);
+    arena_free(ctx, ptr, old_size);
+
+    return tmp;
+}
+
+int vec_arena_init(vec_arena_t * arena, size_t block_size) {
+    arena->allocator.alloc_fn = arena_alloc;
+    arena->allocator.realloc_fn = arena_realloc;
+    arena->allocator.free_fn = arena_free;
+    arena->allocator.ctx = arena;
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? block_size : 4096;
+
+    return VEC_SUCCESS;
+}
+
+int vec_arena_reset(vec_arena_t * arena) {
+    vec_arena_block_t * block = arena->blocks;
+    vec_arena_block_t * next;
+
+    if (block == NULL)
+        return VEC_SUCCESS;
+
+    //keep the oldest block around, the arena is likely to be filled again
+    while (block->next != NULL) {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+
+    block->used = 0;
+    block->last = 0;
+    arena->blocks = block;
+
+    return VEC_SUCCESS;
+}
+
+int vec_arena_destroy(vec_arena_t * arena) {
+    vec_arena_block_t * block = arena->blocks;
+    vec_arena_block_t * next;
+
+    while (block != NULL) {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->blocks = NULL;
+
+    return VEC_SUCCESS;
+}
+
+/*
+ * size class pool
+ */
+
+typedef struct large_block {
+    struct large_block * prev;
+    struct large_block * next;
+} large_block_t;
+
+#define SLAB_HEADER ALIGN_UP(sizeof(void *))
+#define LARGE_HEADER ALIGN_UP(sizeof(large_block_t))
+
+//returns the size class for size, or -1 if it is too big for the pool
+static int size_class(size_t size) {
+    size_t class_size = VEC_POOL_MIN_CLASS;
+    int c = 0;
+
+    if (size > VEC_POOL_MAX_CLASS)
+        return -1;
+
+    while (class_size < size) {
+        class_size <<= 1;
+        c++;
+    }
+
+    return c;
+}
+
+static size_t class_size(int c) {
+    return (size_t)VEC_POOL_MIN_CLASS << c;
+}
+
+//carves a new slab into blocks of class c and puts them on the free list
+static int refill(vec_pool_t * pool, int c) {
+    size_t size = class_size(c);
+    size_t count = (VEC_POOL_SLAB_SIZE - SLAB_HEADER) / size;
+    unsigned char * slab = malloc(VEC_POOL_SLAB_SIZE);
+    unsigned char * block;
+    size_t i;
+
+    if (slab == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    *(void **)slab = pool->slabs;
+    pool->slabs = slab;
+
+    for (i = 0; i < count; i++) {
+        block = slab + SLAB_HEADER + i * size;
+        *(void **)block = pool->free_lists[c];
+        pool->free_lists[c] = block;
+    }
+
+    return VEC_SUCCESS;
+}
+
+static void large_link(vec_pool_t * pool, large_block_t * block) {
+    block->prev = NULL;
+    block->next = pool->large;
+    if (block->next != NULL)
+        block->next->prev = block;
+    pool->large = block;
+}
+
+static void large_unlink(vec_pool_t * pool, large_block_t * block) {
+    if (block->prev != NULL)
+        block->prev->next = block->next;
+    else
+        pool->large = block->next;
+    if (block->next != NULL)
+        block->next->prev = block->prev;
+}
+
+static void * large_alloc(vec_pool_t * pool, size_t size) {
+    large_block_t * block = malloc(LARGE_HEADER + size);
+
+    if (block == NULL)
+        return NULL;
+
+    large_link(pool, block);
+
+    return (unsigned char *)block + LARGE_HEADER;
+}
+
+static void large_free(vec_pool_t * pool, void * ptr) {
+    large_block_t * block = (large_block_t *)((unsigned char *)ptr - LARGE_HEADER);
+
+    large_unlink(pool, block);
+    free(block);
+}
+
+static void * pool_alloc(void * ctx, size_t size) {
+    vec_pool_t * pool = ctx;
+    int c = size_class(size);
+    void * ptr;
+
+    if (c < 0)
+        return large_alloc(pool, size);
+
+    if (pool->free_lists[c] == NULL && refill(pool, c))
+        return NULL;
+
+    ptr = pool->free_lists[c];
+    pool->free_lists[c] = *(void **)ptr;
+
+    return ptr;
+}
+
+static void pool_free(void * ctx, void * ptr, size_t size) {
+    vec_pool_t * pool = ctx;
+    int c = size_class(size);
+
+    if (ptr == NULL)
+        return;
+
+    if (c < 0) {
+        large_free(pool, ptr);
+        return;
+    }
+
+    *(void **)ptr = pool->free_lists[c];
+    pool->free_lists[c] = ptr;
+}
+
+static void * pool_realloc(void * ctx, void * ptr, size_t old_size, size_t new_size) {
+    vec_pool_t * pool = ctx;
+    int old_class = size_class(old_size);
+    int new_class = size_class(new_size);
+    large_block_t * block;
+    void * tmp;
+
+    if (ptr == NULL)
+        return pool_alloc(ctx, new_size);
+
+    //still fits in the same class, nothing to do
+    if (old_class >= 0 && old_class == new_class)
+        return ptr;
+
+    //both too big for the pool, let realloc do it and fix up the links
+    if (old_class < 0 && new_class < 0) {
+        block = (large_block_t *)((unsigned char *)ptr - LARGE_HEADER);
+        large_unlink(pool, block);
+        tmp = realloc(block, LARGE_HEADER + new_size);
+        //realloc failing leaves the block alone, so it goes back in the list either way
+        if (tmp != NULL)
+            block = tmp;
+        large_link(pool, block);
+        return tmp != NULL ? (unsigned char *)block + LARGE_HEADER : NULL;
+    }
+
+    tmp = pool_alloc(ctx, new_size);
+    if (tmp == NULL)
+        return NULL;
+
+    memcpy(tmp, ptr, old_size < new_size ? old_size : new_size);
+    pool_free(ctx, ptr, old_size);
+
+    return tmp;
+}
+
+int vec_pool_init(vec_pool_t * pool) {
+    memset(pool, 0, sizeof(vec_pool_t));
+    pool->allocator.alloc_fn = pool_alloc;
+    pool->allocator.realloc_fn = pool_realloc;
+    pool->allocator.free_fn = pool_free;
+    pool->allocator.ctx = pool;
+
+    return VEC_SUCCESS;
+}
+
+int vec_pool_destroy(vec_pool_t * pool) {
+    void * slab = pool->slabs;
+    void * next;
+    large_block_t * block = pool->large;
+    large_block_t * next_block;
+
+    while (slab != NULL) {
+        next = *(void **)slab;
+        free(slab);
+        slab = next;
+    }
+
+    while (block != NULL) {
+        next_block = block->next;
+        free(block);
+        block = next_block;
+    }
+
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
+    pool->slabs = NULL;
+    pool->large = NULL;
+
+    return VEC_SUCCESS;
+}
@@ -0,0 +1,149 @@
+#ifndef VEC_ALLOC_H
+
+#define VEC_ALLOC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vec_errors.h"
+
+/**
+ * table of allocation functions a vector can be created with instead of
+ * calloc/realloc/free. ctx is passed back to every call. The sizes are in
+ * bytes, and free and realloc are always given the size the block was
+ * allocated with, so allocators do not need to remember it themselves.
+ * alloc does not have to zero the memory.
+ */
+typedef struct {
+    void * (*alloc_fn)(void * ctx, size_t size);
+    void * (*realloc_fn)(void * ctx, void * ptr, size_t old_size, size_t new_size);
+    void (*free_fn)(void * ctx, void * ptr, size_t size);
+    void * ctx;
+} vec_allocator_t;
+
+/**
+ * allocates size zeroed bytes from allocator, or with calloc if allocator is NULL
+ */
+static inline void * vec_mem_alloc(const vec_allocator_t * allocator, size_t size) {
+    void * ptr;
+
+    if (allocator == NULL)
+        return calloc(1, size);
+
+    ptr = allocator->alloc_fn(allocator->ctx, size);
+    if (ptr != NULL)
+        memset(ptr, 0, size);
+
+    return ptr;
+}
+
+/**
+ * resizes a block from allocator, or with realloc if allocator is NULL
+ */
+static inline void * vec_mem_realloc(const vec_allocator_t * allocator, void * ptr, size_t old_size, size_t new_size) {
+    if (allocator == NULL)
+        return realloc(ptr, new_size);
+
+    return allocator->realloc_fn(allocator->ctx, ptr, old_size, new_size);
+}
+
+/**
+ * gives a block back to allocator, or to free if allocator is NULL
+ */
+static inline void vec_mem_free(const vec_allocator_t * allocator, void * ptr, size_t size) {
+    if (allocator == NULL) {
+        free(ptr);
+        return;
+    }
+
+    allocator->free_fn(allocator->ctx, ptr, size);
+}
+
+/**
+ * bump arena. Allocations are carved out of large blocks one after the other,
+ * free only takes back the most recent allocation, and everything is released at
+ * once with vec_arena_reset or vec_arena_destroy. Good for many short lived vectors
+ * that all die together.  Not thread safe.
+ *
+ * Example:
+ *      vec_arena_t arena;
+ *      vec_arena_init(&arena, 1 << 20);
+ *      init_with_allocator(&vector, sizeof(int), 16, &arena.allocator);
+ *      ...
+ *      vec_arena_destroy(&arena);   // no need to destroy the vectors first
+ */
+typedef struct vec_arena_block {
+    struct vec_arena_block * next;
+    size_t size;
+    size_t used;
+    size_t last;
+} vec_arena_block_t;
+
+typedef struct {
+    vec_allocator_t allocator;
+    vec_arena_block_t * blocks;
+    size_t block_size;
+} vec_arena_t;
+
+/**
+ * sets up an arena that grabs memory block_size bytes at a time (or more for bigger allocations)
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_arena_init(vec_arena_t * arena, size_t block_size);
+
+/**
+ * releases everything allocated from the arena but keeps the first block for reuse.
+ * Every vector using the arena becomes invalid.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_arena_reset(vec_arena_t * arena);
+
+/**
+ * releases all memory held by the arena. Every vector using the arena becomes invalid.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_arena_destroy(vec_arena_t * arena);
+
+/**
+ * size class pool. Requests are rounded up to a power of two between
+ * VEC_POOL_MIN_CLASS and VEC_POOL_MAX_CLASS bytes and served from per class free
+ * lists that are refilled a slab at a time, so creating and destroying small vectors
+ * never reaches the system allocator once the pool is warm. Bigger requests go
+ * to malloc but are still tracked, so vec_pool_destroy releases everything at
+ * once.  Not thread safe.
+ */
+#define VEC_POOL_MIN_CLASS 16
+#define VEC_POOL_MAX_CLASS 65536
+#define VEC_POOL_CLASSES 13
+#define VEC_POOL_SLAB_SIZE (256 * 1024)
+
+typedef struct {
+    vec_allocator_t allocator;
+    void * free_lists[VEC_POOL_CLASSES];
+    void * slabs;
+    void * large;
+} vec_pool_t;
+
+/**
+ * sets up an empty pool
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_pool_init(vec_pool_t * pool);
+
+/**
+ * releases all memory held by the pool. Every vector using the pool becomes invalid.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_pool_destroy(vec_pool_t * pool);
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef BENCH_H
+
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * small helpers shared by the benchmarks. Every result is printed as one
+ * JSON object per line so the output can be fed straight into other tools.
+ */
+
+/**
+ * returns a monotonic timestamp in nanoseconds
+ */
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * prints one result line. ops is the number of operations timed, elapsed_ns
+ * the total wall time they took.
+ */
+static inline void bench_report(const char * bench, const char * variant, size_t element_size,
+        size_t n, int threads, uint64_t ops, uint64_t elapsed_ns) {
+    double secs = elapsed_ns / 1e9;
+    printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"element_size\":%zu,\"n\":%zu,"
+            "\"threads\":%d,\"ops\":%llu,\"ns\":%llu,\"ops_per_sec\":%.0f}\n",
+            bench, variant, element_size, n, threads,
+            (unsigned long long)ops, (unsigned long long)elapsed_ns,
+            secs > 0 ? ops / secs : 0.0);
+    fflush(stdout);
+}
+
+/**
+ * keeps the compiler from optimizing away a computed value
+ */
+static volatile uint64_t bench_sink;
+
+/**
+ * latency samples of one benchmark, in nanoseconds per operation. Reading the clock
+ * around a single get would mostly time the clock, so fast operations are timed in
+ * batches and each sample is the mean of its batch, which can be below a nanosecond;
+ * the batch size goes into the report. Samples past capacity are dropped.
+ */
+typedef struct {
+    double * samples;
+    size_t count;
+    size_t capacity;
+} bench_lat_t;
+
+static inline int bench_lat_init(bench_lat_t * lat, size_t capacity) {
+    lat->samples = malloc((capacity > 0 ? capacity : 1) * sizeof(double));
+    lat->count = 0;
+    lat->capacity = capacity;
+    return lat->samples == NULL;
+}
+
+//adds one sample: ns nanoseconds for a batch of ops operations
+static inline void bench_lat_add(bench_lat_t * lat, uint64_t ns, size_t ops) {
+    if (lat->count < lat->capacity)
+        lat->samples[lat->count++] = (double)ns / (ops > 0 ? ops : 1);
+}
+
+//adds the samples of src to dst, for merging the samples of several threads
+static inline void bench_lat_merge(bench_lat_t * dst, bench_lat_t * src) {
+    size_t i;
+
+    for (i = 0; i < src->count; i++)
+        if (dst->count < dst->capacity)
+            dst->samples[dst->count++] = src->samples[i];
+}
+
+static inline void bench_lat_free(bench_lat_t * lat) {
+    free(lat->samples);
+    lat->samples = NULL;
+    lat->count = lat->capacity = 0;
+}
+
+static inline int bench_cmp_double(const void * a, const void * b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+//the p-th percentile (0 to 100) of sorted samples, nearest rank
+static inline double bench_lat_percentile(bench_lat_t * lat, double p) {
+    size_t rank;
+
+    if (lat->count == 0)
+        return 0;
+
+    rank = (size_t)(p / 100.0 * lat->count + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > lat->count)
+        rank = lat->count;
+
+    return lat->samples[rank - 1];
+}
+
+/**
+ * same as bench_report, with the p50, p90, p99, p99.9 and max of the latency samples
+ * added to the line. batch is the number of operations each sample was averaged over.
+ */
+static inline void bench_report_lat(const char * bench, const char * variant, size_t element_size,
+        size_t n, int threads, uint64_t ops, uint64_t elapsed_ns, bench_lat_t * lat, size_t batch) {
+    double secs = elapsed_ns / 1e9;
+
+    qsort(lat->samples, lat->count, sizeof(double), bench_cmp_double);
+    printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"element_size\":%zu,\"n\":%zu,"
+            "\"threads\":%d,\"ops\":%llu,\"ns\":%llu,\"ops_per_sec\":%.0f,"
+            "\"batch\":%zu,\"samples\":%zu,\"p50_ns\":%.1f,\"p90_ns\":%.1f,"
+            "\"p99_ns\":%.1f,\"p999_ns\":%.1f,\"max_ns\":%.1f}\n",
+            bench, variant, element_size, n, threads,
+            (unsigned long long)ops, (unsigned long long)elapsed_ns,
+            secs > 0 ? ops / secs : 0.0, batch, lat->count,
+            bench_lat_percentile(lat, 50),
+            bench_lat_percentile(lat, 90),
+            bench_lat_percentile(lat, 99),
+            bench_lat_percentile(lat, 99.9),
+            bench_lat_percentile(lat, 100));
+    fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * sums one 8 byte field of n 64 byte records, and filters on another, once from a
+ * vec_t of whole structs with VEC_ITER_PTR and VEC_FILTER and once from a col_vec_t
+ * with COL_VEC_SCAN and COL_VEC_FILTER, which only read that field's column.
+ *
+ * build: cmake --build <dir> --target colvec_bench
+ * usage: ./colvec_bench [n]
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "colvec.h"
+#include "bench.h"
+
+typedef struct {
+    uint64_t id;
+    uint64_t price;
+    uint64_t rest[6];
+} record_t;
+
+static const col_field_t fields[] = {
+    {offsetof(record_t, id), sizeof(uint64_t)},
+    {offsetof(record_t, price), sizeof(uint64_t)},
+    {offsetof(record_t, rest), sizeof(((record_t *)0)->rest)},
+};
+
+int main(int argc, char ** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    vec_t rows;
+    col_vec_t cols;
+    record_t r, * rp;
+    uint64_t start, sum, * price;
+    int idx = 0;
+    size_t i;
+
+    memset(&rows, 0, sizeof(vec_t));
+    memset(&cols, 0, sizeof(col_vec_t));
+    init_with_capacity(&rows, sizeof(record_t), n);
+    col_init_with_capacity(&cols, sizeof(record_t), fields, 3, n);
+    memset(&r, 0, sizeof(record_t));
+    for (i = 0; i < n; i++) {
+        r.id = i;
+        r.price = i * 7 % 1000;
+        append(&rows, &r);
+        col_append(&cols, &r);
+    }
+
+    sum = 0;
+    start = bench_now_ns();
+    VEC_ITER_PTR(&rows, rp, sum += rp->price);
+    bench_report("scan", "vec", sizeof(record_t), n, 1, n, bench_now_ns() - start);
+    bench_sink = sum;
+
+    sum = 0;
+    start = bench_now_ns();
+    COL_VEC_SCAN(&cols, 1, price, idx, sum += *price);
+    bench_report("scan", "col_vec", sizeof(record_t), n, 1, n, bench_now_ns() - start);
+    bench_sink = sum + idx;
+
+    start = bench_now_ns();
+    VEC_FILTER(&rows, &r, r.price < 500);
+    bench_report("filter", "vec", sizeof(record_t), n, 1, n, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    COL_VEC_FILTER(&cols, 1, price, *price < 500);
+    bench_report("filter", "col_vec", sizeof(record_t), n, 1, n, bench_now_ns() - start);
+
+    destroy(&rows);
+    col_destroy(&cols);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * compares lf_append against sync_append with 1 to 64 threads all
+ * appending to the same vector.
+ *
+ * build: cmake --build <dir> --target lfvec_bench
+ * usage: ./lfvec_bench [total_appends] [max_threads]
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "svec.h"
+#include "lfvec.h"
+#include "bench.h"
+
+static sync_vec_t svector;
+static lf_vec_t lvector;
+static size_t appends_per_thread;
+
+static void * sync_appender(void * arg) {
+    size_t i;
+    (void)arg;
+    for (i = 0; i < appends_per_thread; i++)
+        sync_append(&svector, &i);
+    return NULL;
+}
+
+static void * lf_appender(void * arg) {
+    size_t i;
+    (void)arg;
+    for (i = 0; i < appends_per_thread; i++)
+        lf_append(&lvector, &i, NULL);
+    return NULL;
+}
+
+static uint64_t run(void * (*fn)(void *), int nthreads) {
+    pthread_t threads[64];
+    uint64_t t = bench_now_ns();
+    int i;
+
+    for (i = 0; i < nthreads; i++)
+        pthread_create(&threads[i], NULL, fn, NULL);
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+
+    return bench_now_ns() - t;
+}
+
+int main(int argc, char ** argv) {
+    size_t total = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : 64;
+    int nthreads;
+    uint64_t t;
+
+    if (max_threads > 64)
+        max_threads = 64;
+
+    for (nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        appends_per_thread = total / nthreads;
+
+        memset(&svector, 0, sizeof(sync_vec_t));
+        sync_init(&svector, sizeof(size_t));
+        t = run(sync_appender, nthreads);
+        bench_report("append", "sync_append", sizeof(size_t), total, nthreads,
+                appends_per_thread * nthreads, t);
+        sync_destroy(&svector);
+
+        memset(&lvector, 0, sizeof(lf_vec_t));
+        lf_init(&lvector, sizeof(size_t));
+        t = run(lf_appender, nthreads);
+        bench_report("append", "lf_append", sizeof(size_t), total, nthreads,
+                appends_per_thread * nthreads, t);
+        lf_destroy(&lvector);
+    }
+
+    return 0;
+}
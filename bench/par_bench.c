@@ -0,0 +1,101 @@
+/**
+ * compares VEC_MAP, VEC_FILTER and a VEC_ITER sum against vec_parallel_map,
+ * vec_parallel_filter and vec_parallel_reduce on n 8 byte elements, with a
+ * per element cost of work rounds of integer mixing.
+ *
+ * build: cmake --build <dir> --target par_bench
+ * usage: ./par_bench [n] [work]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "bench.h"
+#include "../par/vec_par.h"
+
+static int work = 16;
+
+static uint64_t mix(uint64_t x) {
+    for (int i = 0; i < work; i++) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+    }
+    return x;
+}
+
+static void map_fn(const void * src, void * dst, void * ctx) {
+    (void)ctx;
+    *(uint64_t *)dst = mix(*(const uint64_t *)src);
+}
+
+static int pred_fn(const void * element, void * ctx) {
+    (void)ctx;
+    return mix(*(const uint64_t *)element) & 1;
+}
+
+static void reduce_fn(void * acc, const void * element, void * ctx) {
+    (void)ctx;
+    *(uint64_t *)acc += mix(*(const uint64_t *)element);
+}
+
+static void combine_fn(void * acc, const void * other, void * ctx) {
+    (void)ctx;
+    *(uint64_t *)acc += *(const uint64_t *)other;
+}
+
+static void fill(vec_t * vector, size_t n) {
+    memset(vector, 0, sizeof(vec_t));
+    init_with_capacity(vector, sizeof(uint64_t), n);
+    for (uint64_t i = 0; i < n; i++)
+        append(vector, &i);
+}
+
+int main(int argc, char ** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    vec_t src, dst;
+    uint64_t start, sum, x, y;
+    vec_tpool_t * pool = vec_tpool_default();
+    //the calling thread works alongside the pool
+    int threads = pool ? pool->nthreads + 1 : 1;
+
+    if (argc > 2)
+        work = atoi(argv[2]);
+
+    fill(&src, n);
+
+    memset(&dst, 0, sizeof(vec_t));
+    start = bench_now_ns();
+    VEC_MAP(&src, &dst, sizeof(uint64_t), &x, &y, y = mix(x););
+    bench_report("map", "VEC_MAP", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    destroy(&dst);
+
+    memset(&dst, 0, sizeof(vec_t));
+    start = bench_now_ns();
+    vec_parallel_map(&src, &dst, sizeof(uint64_t), map_fn, NULL);
+    bench_report("map", "vec_parallel_map", sizeof(uint64_t), n, threads, n, bench_now_ns() - start);
+    destroy(&dst);
+
+    sum = 0;
+    start = bench_now_ns();
+    VEC_ITER(&src, &x, sum += mix(x));
+    bench_report("reduce", "VEC_ITER", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    bench_sink = sum;
+
+    sum = 0;
+    start = bench_now_ns();
+    vec_parallel_reduce(&src, &sum, sizeof(sum), reduce_fn, combine_fn, NULL);
+    bench_report("reduce", "vec_parallel_reduce", sizeof(uint64_t), n, threads, n, bench_now_ns() - start);
+    bench_sink = sum;
+
+    start = bench_now_ns();
+    VEC_FILTER(&src, &x, mix(x) & 1);
+    bench_report("filter", "VEC_FILTER", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    destroy(&src);
+
+    fill(&src, n);
+    start = bench_now_ns();
+    vec_parallel_filter(&src, pred_fn, NULL);
+    bench_report("filter", "vec_parallel_filter", sizeof(uint64_t), n, threads, n, bench_now_ns() - start);
+    destroy(&src);
+
+    return 0;
+}
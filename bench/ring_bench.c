@@ -0,0 +1,63 @@
+/**
+ * compares a work queue built from sync_append and sync_remove_index(v, 0) against
+ * sync_ring_push_back and sync_ring_pop_front, keeping depth elements queued while
+ * n elements pass through, then draining it.
+ *
+ * build: cmake --build <dir> --target ring_bench
+ * usage: ./ring_bench [n] [depth]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "svec.h"
+#include "sring.h"
+#include "bench.h"
+
+int main(int argc, char ** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t depth = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+    sync_vec_t vector;
+    sync_ring_t ring;
+    uint64_t start, x, sum;
+    size_t i;
+
+    memset(&vector, 0, sizeof(sync_vec_t));
+    sync_init(&vector, sizeof(uint64_t));
+    sum = 0;
+    start = bench_now_ns();
+    for (i = 0; i < n; i++) {
+        x = i;
+        sync_append(&vector, &x);
+        if (i >= depth) {
+            sync_get(&vector, 0, &x);
+            sync_remove_index(&vector, 0);
+            sum += x;
+        }
+    }
+    while (sync_get(&vector, 0, &x) == VEC_SUCCESS) {
+        sync_remove_index(&vector, 0);
+        sum += x;
+    }
+    bench_report("queue", "sync_vec", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    bench_sink = sum;
+    sync_destroy(&vector);
+
+    memset(&ring, 0, sizeof(sync_ring_t));
+    sync_ring_init(&ring, sizeof(uint64_t));
+    sum = 0;
+    start = bench_now_ns();
+    for (i = 0; i < n; i++) {
+        x = i;
+        sync_ring_push_back(&ring, &x);
+        if (i >= depth) {
+            sync_ring_pop_front(&ring, &x);
+            sum += x;
+        }
+    }
+    while (sync_ring_pop_front(&ring, &x) == VEC_SUCCESS)
+        sum += x;
+    bench_report("queue", "sync_ring", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    bench_sink = sum;
+    sync_ring_destroy(&ring);
+
+    return 0;
+}
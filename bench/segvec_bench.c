@@ -0,0 +1,65 @@
+/**
+ * compares append on vec_t against seg_vec_t for n 8 byte elements: the total time,
+ * and the single slowest append, which for vec_t is the last realloc copying
+ * everything stored so far.
+ *
+ * build: cmake --build <dir> --target segvec_bench
+ * usage: ./segvec_bench [n]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "segvec.h"
+#include "bench.h"
+
+int main(int argc, char ** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+    vec_t vector;
+    seg_vec_t segvec;
+    uint64_t start, t, worst, x;
+    size_t i;
+
+    memset(&vector, 0, sizeof(vec_t));
+    init(&vector, sizeof(uint64_t));
+    worst = 0;
+    start = bench_now_ns();
+    for (i = 0; i < n; i++) {
+        x = i;
+        t = bench_now_ns();
+        append(&vector, &x);
+        t = bench_now_ns() - t;
+        if (t > worst)
+            worst = t;
+    }
+    bench_report("append", "vec", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    bench_report("append_worst", "vec", sizeof(uint64_t), n, 1, 1, worst);
+    destroy(&vector);
+
+    memset(&segvec, 0, sizeof(seg_vec_t));
+    seg_init(&segvec, sizeof(uint64_t));
+    worst = 0;
+    start = bench_now_ns();
+    for (i = 0; i < n; i++) {
+        x = i;
+        t = bench_now_ns();
+        seg_append(&segvec, &x);
+        t = bench_now_ns() - t;
+        if (t > worst)
+            worst = t;
+    }
+    bench_report("append", "seg_vec", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    bench_report("append_worst", "seg_vec", sizeof(uint64_t), n, 1, 1, worst);
+
+    //reading back through the segment table
+    x = 0;
+    start = bench_now_ns();
+    for (i = 0; i < n; i++) {
+        seg_get(&segvec, i, &t);
+        x += t;
+    }
+    bench_report("get", "seg_vec", sizeof(uint64_t), n, 1, n, bench_now_ns() - start);
+    bench_sink = x;
+    seg_destroy(&segvec);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * compares sort (qsort) against VEC_SORT_BY, radix_sort and parallel_sort with 1 to
+ * max_threads threads for 4, 8 and 64 byte elements, at 1M elements and every
+ * tenfold step up to max_n (pass 100000000 for the full 1M to 100M range).
+ *
+ * build: cmake --build <dir> --target sort_bench
+ * usage: ./sort_bench [max_n] [max_threads]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "bench.h"
+
+typedef struct {
+    uint64_t w[8];
+} rec64_t;
+
+static int cmp_u32(const void * a, const void * b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_u64(const void * a, const void * b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_rec64(const void * a, const void * b) {
+    return cmp_u64(&((const rec64_t *)a)->w[0], &((const rec64_t *)b)->w[0]);
+}
+
+static uint64_t next_random(uint64_t * state) {
+    //xorshift64, plenty for shuffled keys
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+//fills the vector with the same n random keys every time, so each run sorts identical input
+static void fill(vec_t * vector, size_t element_size, size_t n) {
+    uint64_t state = 88172645463325252ull;
+    unsigned char * p = vec_data(vector);
+    uint64_t key;
+    size_t i;
+
+    memset(p, 0, n * element_size);
+    for (i = 0; i < n; i++) {
+        key = next_random(&state);
+        memcpy(p + i * element_size, &key, element_size < 8 ? element_size : 8);
+    }
+    vector->used_slots = n;
+}
+
+//VEC_SORT_BY needs the type at compile time, so each element size gets its own
+#define SORT_BY(vector, element_size) do { \
+    if ((element_size) == sizeof(uint32_t)) \
+        VEC_SORT_BY(vector, uint32_t, a, b, *a < *b); \
+    else if ((element_size) == sizeof(uint64_t)) \
+        VEC_SORT_BY(vector, uint64_t, a, b, *a < *b); \
+    else \
+        VEC_SORT_BY(vector, rec64_t, a, b, a->w[0] < b->w[0]); \
+} while (0)
+
+static void run(size_t element_size, cmpfn cmp, size_t n, int max_threads) {
+    vec_t vector;
+    uint64_t t;
+    int threads;
+
+    memset(&vector, 0, sizeof(vec_t));
+    if (init_with_capacity(&vector, element_size, (int)n) != VEC_SUCCESS) {
+        fprintf(stderr, "could not allocate %zu elements\n", n);
+        exit(1);
+    }
+
+    fill(&vector, element_size, n);
+    t = bench_now_ns();
+    sort(&vector, cmp);
+    bench_report("sort", "qsort", element_size, n, 1, n, bench_now_ns() - t);
+
+    fill(&vector, element_size, n);
+    t = bench_now_ns();
+    SORT_BY(&vector, element_size);
+    bench_report("sort", "VEC_SORT_BY", element_size, n, 1, n, bench_now_ns() - t);
+
+    //the key is the first 4 or 8 bytes, the same one the comparisons look at
+    fill(&vector, element_size, n);
+    t = bench_now_ns();
+    radix_sort(&vector, 0, element_size < 8 ? element_size : 8, VEC_RADIX_UNSIGNED);
+    bench_report("sort", "radix_sort", element_size, n, 1, n, bench_now_ns() - t);
+
+    for (threads = 1; threads <= max_threads; threads *= 2) {
+        fill(&vector, element_size, n);
+        t = bench_now_ns();
+        parallel_sort(&vector, cmp, threads);
+        bench_report("sort", "parallel_sort", element_size, n, threads, n, bench_now_ns() - t);
+    }
+
+    destroy(&vector);
+}
+
+int main(int argc, char ** argv) {
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : 16;
+    size_t n;
+
+    for (n = 1000000; n <= max_n; n *= 10) {
+        run(sizeof(uint32_t), cmp_u32, n, max_threads);
+        run(sizeof(uint64_t), cmp_u64, n, max_threads);
+        run(sizeof(rec64_t), cmp_rec64, n, max_threads);
+    }
+
+    return 0;
+}
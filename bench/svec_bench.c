@@ -0,0 +1,173 @@
+/**
+ * the multi threaded sync_vec_t suite. 1 to max_threads threads, doubling, share one
+ * vector of VECTOR_SIZE 16 byte elements and each run ops_per_thread operations of
+ * a workload:
+ *  read:   sync_get at random positions
+ *  mixed:  90% sync_get, 10% sync_replace
+ *  write:  sync_append and sync_remove_index of the last element, alternating
+ *  sort:   sync_get, but every 10000th operation sorts the whole vector with sync_sort
+ * Every line carries total throughput and the latency percentiles of all threads together,
+ * which include the time spent waiting for the lock.
+ *
+ * build: cmake --build <dir> --target svec_bench
+ * usage: ./svec_bench [max_threads] [ops_per_thread]
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "svec.h"
+#include "bench.h"
+
+#define VECTOR_SIZE 100000
+#define MAX_THREADS 256
+#define BATCH 8
+
+typedef struct {
+    uint32_t key;
+    uint32_t pad[3];
+} element_t;
+
+enum workload { READ, MIXED, WRITE, SORT };
+
+static const char * workload_names[] = {"read", "mixed", "write", "sort"};
+
+typedef struct {
+    enum workload workload;
+    uint64_t seed;
+    uint64_t start;
+    uint64_t end;
+    bench_lat_t lat;
+} worker_t;
+
+static sync_vec_t vector;
+static size_t ops_per_thread;
+static pthread_barrier_t start_barrier;
+
+static uint64_t next_random(uint64_t * state) {
+    //xorshift64, plenty for positions and keys
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int cmp_key(const void * a, const void * b) {
+    uint32_t x = ((const element_t *)a)->key, y = ((const element_t *)b)->key;
+    return (x > y) - (x < y);
+}
+
+static void run_op(worker_t * w, size_t i) {
+    element_t e = {0};
+    uint64_t r = next_random(&w->seed);
+
+    switch (w->workload) {
+        case READ:
+            sync_get(&vector, r % VECTOR_SIZE, &e);
+            break;
+        case MIXED:
+            if (r % 10 == 0) {
+                e.key = (uint32_t)r;
+                sync_replace(&vector, &e, r % VECTOR_SIZE);
+            } else {
+                sync_get(&vector, r % VECTOR_SIZE, &e);
+            }
+            break;
+        case WRITE:
+            if (i % 2 == 0) {
+                e.key = (uint32_t)r;
+                sync_append(&vector, &e);
+            } else {
+                //find the last element and remove it under one lock
+                sync_begin(&vector);
+                sync_remove_index_locked(&vector, vector.used_slots - 1);
+                sync_commit(&vector);
+            }
+            break;
+        case SORT:
+            if (i % 10000 == 9999)
+                sync_sort(&vector, cmp_key);
+            else
+                sync_get(&vector, r % VECTOR_SIZE, &e);
+            break;
+    }
+    bench_sink = e.key;
+}
+
+static void * worker(void * arg) {
+    worker_t * w = arg;
+    uint64_t t;
+    size_t i, j;
+
+    pthread_barrier_wait(&start_barrier);
+    w->start = bench_now_ns();
+    for (i = 0; i < ops_per_thread; i += BATCH) {
+        t = bench_now_ns();
+        for (j = i; j < i + BATCH && j < ops_per_thread; j++)
+            run_op(w, j);
+        bench_lat_add(&w->lat, bench_now_ns() - t, j - i);
+    }
+    w->end = bench_now_ns();
+
+    return NULL;
+}
+
+static void run(enum workload workload, int nthreads) {
+    static pthread_t threads[MAX_THREADS];
+    static worker_t workers[MAX_THREADS];
+    uint64_t start = UINT64_MAX, end = 0;
+    bench_lat_t all;
+    int i;
+
+    bench_lat_init(&all, (ops_per_thread / BATCH + 1) * nthreads);
+    pthread_barrier_init(&start_barrier, NULL, nthreads + 1);
+    for (i = 0; i < nthreads; i++) {
+        workers[i].workload = workload;
+        workers[i].seed = i + 1;
+        bench_lat_init(&workers[i].lat, ops_per_thread / BATCH + 1);
+        pthread_create(&threads[i], NULL, worker, &workers[i]);
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+
+    //from the first thread starting to the last one finishing
+    for (i = 0; i < nthreads; i++) {
+        if (workers[i].start < start)
+            start = workers[i].start;
+        if (workers[i].end > end)
+            end = workers[i].end;
+        bench_lat_merge(&all, &workers[i].lat);
+        bench_lat_free(&workers[i].lat);
+    }
+    bench_report_lat(workload_names[workload], "sync_vec", sizeof(element_t), VECTOR_SIZE, nthreads,
+            (uint64_t)nthreads * ops_per_thread, end - start, &all, BATCH);
+
+    pthread_barrier_destroy(&start_barrier);
+    bench_lat_free(&all);
+}
+
+int main(int argc, char ** argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    uint64_t seed = 1;
+    element_t e = {0};
+    int workload, nthreads, i;
+
+    ops_per_thread = argc > 2 ? strtoul(argv[2], NULL, 10) : 200000;
+    if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+
+    memset(&vector, 0, sizeof(sync_vec_t));
+    sync_init_with_capacity(&vector, sizeof(element_t), VECTOR_SIZE);
+    for (i = 0; i < VECTOR_SIZE; i++) {
+        e.key = (uint32_t)next_random(&seed);
+        sync_append(&vector, &e);
+    }
+
+    for (workload = READ; workload <= SORT; workload++)
+        for (nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+            run(workload, nthreads);
+
+    sync_destroy(&vector);
+    return 0;
+}
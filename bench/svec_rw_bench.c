@@ -0,0 +1,85 @@
+/**
+ * measures how sync_get throughput scales with the number of reader threads
+ * while one writer thread replaces elements as fast as it can get the lock.
+ *
+ * build: cmake --build <dir> --target svec_rw_bench
+ * usage: ./svec_rw_bench [max_threads] [reads_per_thread]
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "svec.h"
+#include "bench.h"
+
+#define VECTOR_SIZE 100000
+
+static sync_vec_t vector;
+static size_t reads_per_thread;
+static volatile int readers_done;
+
+static void * reader(void * arg) {
+    unsigned int seed = (unsigned int)(uintptr_t)arg;
+    uint64_t sum = 0;
+    size_t i;
+    int x;
+
+    for (i = 0; i < reads_per_thread; i++) {
+        sync_get(&vector, rand_r(&seed) % VECTOR_SIZE, &x);
+        sum += x;
+    }
+    bench_sink = sum;
+    return NULL;
+}
+
+static void * writer(void * arg) {
+    unsigned int seed = 1;
+    size_t * writes = arg;
+    int x;
+
+    while (!readers_done) {
+        x = rand_r(&seed);
+        sync_replace(&vector, &x, x % VECTOR_SIZE);
+        (*writes)++;
+    }
+    return NULL;
+}
+
+int main(int argc, char ** argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    pthread_t threads[256], writer_thread;
+    size_t writes;
+    uint64_t t;
+    int nthreads, i;
+
+    reads_per_thread = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (max_threads > 256)
+        max_threads = 256;
+
+    memset(&vector, 0, sizeof(sync_vec_t));
+    sync_init_with_capacity(&vector, sizeof(int), VECTOR_SIZE);
+    for (i = 0; i < VECTOR_SIZE; i++)
+        sync_append(&vector, &i);
+
+    for (nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        readers_done = 0;
+        writes = 0;
+        pthread_create(&writer_thread, NULL, writer, &writes);
+
+        t = bench_now_ns();
+        for (i = 0; i < nthreads; i++)
+            pthread_create(&threads[i], NULL, reader, (void *)(uintptr_t)(i + 1));
+        for (i = 0; i < nthreads; i++)
+            pthread_join(threads[i], NULL);
+        t = bench_now_ns() - t;
+
+        readers_done = 1;
+        pthread_join(writer_thread, NULL);
+
+        bench_report("sync_get", "rwlock", sizeof(int), VECTOR_SIZE, nthreads,
+                (uint64_t)nthreads * reads_per_thread, t);
+        bench_report("sync_replace", "rwlock", sizeof(int), VECTOR_SIZE, nthreads, writes, t);
+    }
+
+    sync_destroy(&vector);
+    return 0;
+}
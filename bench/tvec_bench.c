@@ -0,0 +1,100 @@
+/**
+ * compares the generic vec_t against VEC_DECLARE'd vectors for 4, 8 and 64 byte elements.
+ *
+ * build: cmake --build <dir> --target tvec_bench
+ * usage: ./tvec_bench [n]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "tvec.h"
+#include "bench.h"
+
+typedef struct {
+    uint64_t w[8];
+} rec64_t;
+
+VEC_DECLARE(uint32_t, u32vec)
+VEC_DEFINE(uint32_t, u32vec)
+VEC_DECLARE(uint64_t, u64vec)
+VEC_DEFINE(uint64_t, u64vec)
+VEC_DECLARE(rec64_t, rec64vec)
+VEC_DEFINE(rec64_t, rec64vec)
+
+#define KEY_u32(x) (x)
+#define KEY_u64(x) (x)
+#define KEY_rec64(x) ((x).w[0])
+#define SET_u32(x, v) ((x) = (uint32_t)(v))
+#define SET_u64(x, v) ((x) = (uint64_t)(v))
+#define SET_rec64(x, v) ((x).w[0] = (uint64_t)(v))
+
+/*
+ * runs append, get and iterate over n elements of type T, once through
+ * vec_t and once through the typed vector name
+ */
+#define RUN_BENCH(T, tag, name, n) do { \
+    vec_t _gv; \
+    name##_t _tv; \
+    T _x, * _p; \
+    uint64_t _t, _sum; \
+    size_t _i; \
+    memset(&_x, 0, sizeof(T)); \
+    memset(&_gv, 0, sizeof(vec_t)); \
+    memset(&_tv, 0, sizeof(name##_t)); \
+    init(&_gv, sizeof(T)); \
+    name##_init(&_tv); \
+\
+    _t = bench_now_ns(); \
+    for (_i = 0; _i < (n); _i++) { \
+        SET_##tag(_x, _i); \
+        append(&_gv, &_x); \
+    } \
+    bench_report("append", "vec_t", sizeof(T), n, 1, n, bench_now_ns() - _t); \
+    _t = bench_now_ns(); \
+    for (_i = 0; _i < (n); _i++) { \
+        SET_##tag(_x, _i); \
+        name##_append(&_tv, _x); \
+    } \
+    bench_report("append", #name, sizeof(T), n, 1, n, bench_now_ns() - _t); \
+\
+    _sum = 0; \
+    _t = bench_now_ns(); \
+    for (_i = 0; _i < (n); _i++) { \
+        get(&_gv, _i, &_x); \
+        _sum += KEY_##tag(_x); \
+    } \
+    bench_report("get", "vec_t", sizeof(T), n, 1, n, bench_now_ns() - _t); \
+    bench_sink = _sum; \
+    _sum = 0; \
+    _t = bench_now_ns(); \
+    for (_i = 0; _i < (n); _i++) { \
+        name##_get(&_tv, _i, &_x); \
+        _sum += KEY_##tag(_x); \
+    } \
+    bench_report("get", #name, sizeof(T), n, 1, n, bench_now_ns() - _t); \
+    bench_sink = _sum; \
+\
+    _sum = 0; \
+    _t = bench_now_ns(); \
+    VEC_ITER(&_gv, &_x, _sum += KEY_##tag(_x)); \
+    bench_report("iterate", "vec_t", sizeof(T), n, 1, n, bench_now_ns() - _t); \
+    bench_sink = _sum; \
+    _sum = 0; \
+    _t = bench_now_ns(); \
+    TVEC_ITER(&_tv, _p, _sum += KEY_##tag(*_p)); \
+    bench_report("iterate", #name, sizeof(T), n, 1, n, bench_now_ns() - _t); \
+    bench_sink = _sum; \
+\
+    destroy(&_gv); \
+    name##_destroy(&_tv); \
+} while (0)
+
+int main(int argc, char ** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    RUN_BENCH(uint32_t, u32, u32vec, n);
+    RUN_BENCH(uint64_t, u64, u64vec, n);
+    RUN_BENCH(rec64_t, rec64, rec64vec, n);
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * the single threaded vec_t suite: append, get, iterate, insert, remove_index and sort
+ * for 4, 16 and 64 byte elements, on vectors of 1000 elements and every tenfold
+ * step up to max_n. Every line carries throughput and latency percentiles.
+ * insert and remove_index are timed one call at a time, the rest in batches.
+ *
+ * build: cmake --build <dir> --target vec_bench
+ * usage: ./vec_bench [max_n]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "bench.h"
+
+#define MAX_ELEMENT 64
+//shifting inserts and removes are O(n) each, so only this many are timed per size
+#define SHIFT_OPS 10000
+#define GET_OPS 1000000
+#define ITER_ELEMENTS 10000000
+#define SORT_REPS 3
+#define BATCH 64
+
+static const size_t element_sizes[] = {4, 16, 64};
+
+static uint64_t next_random(uint64_t * state) {
+    //xorshift64, plenty for shuffled keys and positions
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+//every element carries a 32 bit key in its first bytes, the rest is zero
+static void make_element(unsigned char * element, size_t element_size, uint32_t key) {
+    memset(element, 0, element_size);
+    memcpy(element, &key, sizeof(key));
+}
+
+static int cmp_key(const void * a, const void * b) {
+    uint32_t x, y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+static void fill(vec_t * vector, size_t element_size, size_t n, uint64_t seed) {
+    unsigned char element[MAX_ELEMENT];
+    size_t i;
+
+    memset(vector, 0, sizeof(vec_t));
+    init_with_capacity(vector, element_size, n);
+    for (i = 0; i < n; i++) {
+        make_element(element, element_size, (uint32_t)next_random(&seed));
+        append(vector, element);
+    }
+}
+
+static void bench_append(size_t element_size, size_t n) {
+    unsigned char element[MAX_ELEMENT];
+    bench_lat_t lat;
+    vec_t vector;
+    uint64_t start, t;
+    size_t i, j;
+
+    bench_lat_init(&lat, n / BATCH + 1);
+    memset(&vector, 0, sizeof(vec_t));
+    init(&vector, element_size);
+    make_element(element, element_size, 1);
+
+    start = bench_now_ns();
+    for (i = 0; i < n; i += BATCH) {
+        t = bench_now_ns();
+        for (j = i; j < i + BATCH && j < n; j++)
+            append(&vector, element);
+        bench_lat_add(&lat, bench_now_ns() - t, j - i);
+    }
+    bench_report_lat("append", "vec", element_size, n, 1, n, bench_now_ns() - start, &lat, BATCH);
+
+    destroy(&vector);
+    bench_lat_free(&lat);
+}
+
+static void bench_get(vec_t * vector, size_t n) {
+    unsigned char element[MAX_ELEMENT];
+    uint64_t seed = 7, start, t, sum = 0;
+    bench_lat_t lat;
+    size_t i, j;
+
+    bench_lat_init(&lat, GET_OPS / BATCH + 1);
+    start = bench_now_ns();
+    for (i = 0; i < GET_OPS; i += BATCH) {
+        t = bench_now_ns();
+        for (j = i; j < i + BATCH; j++) {
+            get(vector, next_random(&seed) % n, element);
+            sum += element[0];
+        }
+        bench_lat_add(&lat, bench_now_ns() - t, BATCH);
+    }
+    bench_report_lat("get", "vec", vector->element_size, n, 1, i, bench_now_ns() - start, &lat, BATCH);
+    bench_sink = sum;
+
+    bench_lat_free(&lat);
+}
+
+static void bench_iterate(vec_t * vector, size_t n) {
+    size_t passes = ITER_ELEMENTS / n > 0 ? ITER_ELEMENTS / n : 1, i;
+    uint64_t start, t, sum = 0;
+    unsigned char * element;
+    bench_lat_t lat;
+
+    bench_lat_init(&lat, passes);
+    start = bench_now_ns();
+    for (i = 0; i < passes; i++) {
+        t = bench_now_ns();
+        VEC_ITER_PTR(vector, element, sum += element[0]);
+        bench_lat_add(&lat, bench_now_ns() - t, n);
+    }
+    bench_report_lat("iterate", "vec", vector->element_size, n, 1, passes * n, bench_now_ns() - start, &lat, n);
+    bench_sink = sum;
+
+    bench_lat_free(&lat);
+}
+
+static void bench_insert_remove(vec_t * vector, size_t n) {
+    size_t ops = n < SHIFT_OPS ? n : SHIFT_OPS, i;
+    unsigned char element[MAX_ELEMENT];
+    uint64_t seed = 11, start, t;
+    bench_lat_t lat;
+
+    make_element(element, vector->element_size, 1);
+
+    bench_lat_init(&lat, ops);
+    start = bench_now_ns();
+    for (i = 0; i < ops; i++) {
+        t = bench_now_ns();
+        insert(vector, element, next_random(&seed) % (veclen(vector) + 1));
+        bench_lat_add(&lat, bench_now_ns() - t, 1);
+    }
+    bench_report_lat("insert", "vec", vector->element_size, n, 1, ops, bench_now_ns() - start, &lat, 1);
+
+    //back down to n
+    lat.count = 0;
+    start = bench_now_ns();
+    for (i = 0; i < ops; i++) {
+        t = bench_now_ns();
+        remove_index(vector, next_random(&seed) % veclen(vector));
+        bench_lat_add(&lat, bench_now_ns() - t, 1);
+    }
+    bench_report_lat("remove_index", "vec", vector->element_size, n, 1, ops, bench_now_ns() - start, &lat, 1);
+
+    bench_lat_free(&lat);
+}
+
+static void bench_sort(size_t element_size, size_t n) {
+    uint64_t t, elapsed = 0;
+    bench_lat_t lat;
+    vec_t vector;
+    int rep;
+
+    bench_lat_init(&lat, SORT_REPS);
+    for (rep = 0; rep < SORT_REPS; rep++) {
+        fill(&vector, element_size, n, 42 + rep);
+        t = bench_now_ns();
+        sort(&vector, cmp_key);
+        t = bench_now_ns() - t;
+        elapsed += t;
+        bench_lat_add(&lat, t, n);
+        destroy(&vector);
+    }
+    bench_report_lat("sort", "vec", element_size, n, 1, (uint64_t)SORT_REPS * n, elapsed, &lat, n);
+
+    bench_lat_free(&lat);
+}
+
+int main(int argc, char ** argv) {
+    size_t max_n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    vec_t vector;
+    size_t n, e;
+
+    for (e = 0; e < sizeof(element_sizes) / sizeof(element_sizes[0]); e++) {
+        for (n = 1000; n <= max_n; n *= 10) {
+            bench_append(element_sizes[e], n);
+
+            fill(&vector, element_sizes[e], n, 1);
+            bench_get(&vector, n);
+            bench_iterate(&vector, n);
+            bench_insert_remove(&vector, n);
+            destroy(&vector);
+
+            bench_sort(element_sizes[e], n);
+        }
+    }
+
+    return 0;
+}
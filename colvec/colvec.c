@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include <string.h>
+#include "colvec.h"
+
+#define MIN_SIZE 64
+#define COLUMN_ALIGN 16
+
+static size_t column_bytes(col_vec_t * vector, int field, uint32_t slots) {
+    size_t bytes = (size_t)slots * vector->fields[field].size;
+    return (bytes + COLUMN_ALIGN - 1) & ~(size_t)(COLUMN_ALIGN - 1);
+}
+
+/*
+ * moves the columns into one new block with room for new_slots rows. A realloc could
+ * not keep the columns apart, since each one has to grow in place.
+ */
+static int resize(col_vec_t * vector, uint32_t new_slots) {
+    size_t size = 0, offset = 0;
+    void * block;
+    int k;
+
+    for (k = 0; k < vector->field_count; k++)
+        size += column_bytes(vector, k, new_slots);
+
+    block = vec_mem_alloc(vector->allocator, size);
+    if (block == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    for (k = 0; k < vector->field_count; k++) {
+        if (vector->block != NULL)
+            memcpy(block + offset, vector->columns[k], (size_t)vector->used_slots * vector->fields[k].size);
+        vector->columns[k] = block + offset;
+        offset += column_bytes(vector, k, new_slots);
+    }
+
+    if (vector->block != NULL)
+        vec_mem_free(vector->allocator, vector->block, vector->block_size);
+
+    vector->block = block;
+    vector->block_size = size;
+    vector->allocated_slots = new_slots;
+
+    return VEC_SUCCESS;
+}
+
+int col_init(col_vec_t * vector, size_t row_size, const col_field_t * fields, int field_count) {
+    return col_init_with_capacity(vector, row_size, fields, field_count, MIN_SIZE);
+}
+
+int col_init_with_capacity(col_vec_t * vector, size_t row_size, const col_field_t * fields, int field_count, int capacity) {
+    int k, res;
+
+    //check already initialized
+    if (vector->block != NULL)
+        return VEC_ALREADY_INITIALIZED;
+
+    if (fields == NULL || field_count <= 0 || capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    for (k = 0; k < field_count; k++)
+        if (fields[k].size == 0 || fields[k].offset + fields[k].size > row_size)
+            return VEC_INVALID_ARGUMENT;
+
+    //the layout is small and fixed, so it lives in one calloc next to the column pointers
+    vector->fields = calloc(field_count, sizeof(col_field_t) + sizeof(void *));
+    if (vector->fields == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    memcpy(vector->fields, fields, field_count * sizeof(col_field_t));
+    vector->columns = (void **)(vector->fields + field_count);
+    vector->field_count = field_count;
+    vector->row_size = row_size;
+    vector->used_slots = 0;
+
+    //always hold at least one slot so the vector reads as initialized
+    if ((res = resize(vector, capacity > 0 ? capacity : 1))) {
+        free(vector->fields);
+        vector->fields = NULL;
+        vector->columns = NULL;
+        return res;
+    }
+
+    return VEC_SUCCESS;
+}
+
+int col_append(col_vec_t * vector, void * row_ptr) {
+    int k;
+
+    if (row_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (vector->used_slots == vector->allocated_slots) {
+        if (vector->allocated_slots >= INT32_MAX / 2)
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+        if (resize(vector, vector->allocated_slots * 2))
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
+
+    for (k = 0; k < vector->field_count; k++)
+        memcpy(COL_VEC_AT(vector, k, vector->used_slots), row_ptr + vector->fields[k].offset, vector->fields[k].size);
+    vector->used_slots++;
+
+    return VEC_SUCCESS;
+}
+
+int col_get(col_vec_t * vector, int idx, void * row_buffer) {
+    int k;
+
+    if (row_buffer == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    for (k = 0; k < vector->field_count; k++)
+        memcpy(row_buffer + vector->fields[k].offset, COL_VEC_AT(vector, k, idx), vector->fields[k].size);
+
+    return VEC_SUCCESS;
+}
+
+int col_replace(col_vec_t * vector, void * row_ptr, int idx) {
+    int k;
+
+    if (row_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    for (k = 0; k < vector->field_count; k++)
+        memcpy(COL_VEC_AT(vector, k, idx), row_ptr + vector->fields[k].offset, vector->fields[k].size);
+
+    return VEC_SUCCESS;
+}
+
+int col_get_field(col_vec_t * vector, int idx, int field, void * value_buffer) {
+    if (value_buffer == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots && field >= 0 && field < vector->field_count))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    memcpy(value_buffer, COL_VEC_AT(vector, field, idx), vector->fields[field].size);
+
+    return VEC_SUCCESS;
+}
+
+int col_replace_field(col_vec_t * vector, void * value_ptr, int idx, int field) {
+    if (value_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots && field >= 0 && field < vector->field_count))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    memcpy(COL_VEC_AT(vector, field, idx), value_ptr, vector->fields[field].size);
+
+    return VEC_SUCCESS;
+}
+
+int col_column(col_vec_t * vector, int field, void ** column_ptr) {
+    if (column_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (!(field >= 0 && field < vector->field_count))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    *column_ptr = vector->columns[field];
+
+    return VEC_SUCCESS;
+}
+
+void col_move_rows(col_vec_t * vector, uint32_t dst, uint32_t src, uint32_t count) {
+    int k;
+
+    if (dst == src || count == 0)
+        return;
+
+    for (k = 0; k < vector->field_count; k++)
+        memmove(COL_VEC_AT(vector, k, dst), COL_VEC_AT(vector, k, src), (size_t)count * vector->fields[k].size);
+}
+
+int col_remove_index(col_vec_t * vector, int idx) {
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    col_move_rows(vector, idx, idx + 1, vector->used_slots - idx - 1);
+    vector->used_slots--;
+
+    return VEC_SUCCESS;
+}
+
+int col_truncate(col_vec_t * vector, int len) {
+    //check bounds
+    if (!(len >= 0 && (uint32_t)len <= vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    vector->used_slots = len;
+
+    return VEC_SUCCESS;
+}
+
+int col_veclen(col_vec_t * vector) {
+    return vector->used_slots;
+}
+
+int col_reserve(col_vec_t * vector, int capacity) {
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    if ((uint32_t)capacity <= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    //grow to exactly the requested size, the caller knows best
+    return resize(vector, capacity);
+}
+
+int col_destroy(col_vec_t * vector) {
+    if (vector->block == NULL)
+        return VEC_ALREADY_DESTROYED;
+
+    vec_mem_free(vector->allocator, vector->block, vector->block_size);
+    free(vector->fields);
+    memset(vector, 0, sizeof(col_vec_t));
+
+    return VEC_SUCCESS;
+}
@@ -0,0 +1,262 @@
+#ifndef COLVEC_H
+
+#define COLVEC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vec_errors.h"
+#include "../alloc/vec_alloc.h"
+
+/**
+ * A vector of structs stored as one array per field (structure of arrays), so a scan
+ * over one field reads only that field's bytes instead of every whole struct.
+ *
+ * The layout is given as a list of fields, each the offset and size of a member of
+ * the row struct, normally written with offsetof and sizeof. Rows go in and come out
+ * as whole structs with col_append, col_get and col_replace, the field arrays are read
+ * one at a time with COL_VEC_SCAN, COL_VEC_FIND_BY and COL_VEC_FILTER. Bytes of the
+ * struct not covered by any field, like padding, are not stored.
+ *
+ * All columns share one allocation, each starting on a 16 byte boundary.
+ */
+typedef struct {
+    size_t offset;
+    size_t size;
+} col_field_t;
+
+typedef struct {
+    uint32_t allocated_slots;
+    uint32_t used_slots;
+    size_t row_size;
+    int field_count;
+    col_field_t * fields;
+    void ** columns;
+    void * block;
+    size_t block_size;
+    const vec_allocator_t * allocator;
+} col_vec_t;
+
+/**
+ * given a pointer to a zeroed col_vec_t struct, the size of the row struct and
+ * field_count fields within it, initializes the vector with some memory. The
+ * fields are copied. Field k is column k in the column functions and macros.
+ * The memory for the columns comes from vector->allocator, which may be set on
+ * the zeroed vector beforehand, see alloc/vec_alloc.h
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT if there are no fields, or one is empty or does not fit in the row
+ */
+int col_init(col_vec_t * vector, size_t row_size, const col_field_t * fields, int field_count);
+
+/**
+ * same as col_init, but allocates room for capacity rows up front.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int col_init_with_capacity(col_vec_t * vector, size_t row_size, const col_field_t * fields, int field_count, int capacity);
+
+/**
+ * splits the row struct pointed to by row_ptr into its fields and appends
+ * each to its column, growing every column if they are full.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int col_append(col_vec_t * vector, void * row_ptr);
+
+/**
+ * gathers the fields of the row at the given index into the row struct
+ * pointed to by row_buffer. Bytes not covered by a field are left alone.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int col_get(col_vec_t * vector, int idx, void * row_buffer);
+
+/**
+ * overwrites every field of the row at the given index with the fields of row_ptr
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int col_replace(col_vec_t * vector, void * row_ptr, int idx);
+
+/**
+ * copies field field of the row at the given index into value_buffer,
+ * which must hold the field's size.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS if idx or field is out of range
+ *  VEC_NULL_BUFFER
+ */
+int col_get_field(col_vec_t * vector, int idx, int field, void * value_buffer);
+
+/**
+ * overwrites field field of the row at the given index with the value value_ptr points to
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS if idx or field is out of range
+ *  VEC_NULL_BUFFER
+ */
+int col_replace_field(col_vec_t * vector, void * value_ptr, int idx, int field);
+
+/**
+ * sets column_ptr to point at the array holding field field of every row, veclen
+ * values of the field's size each. The pointer is only good until the next append
+ * or col_reserve.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS if field is out of range
+ *  VEC_NULL_BUFFER
+ */
+int col_column(col_vec_t * vector, int field, void ** column_ptr);
+
+/**
+ * removes the row at the given index and shifts every column after it over to the left.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ */
+int col_remove_index(col_vec_t * vector, int idx);
+
+/**
+ * removes every row from position len on.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS if len is negative or larger than the vector
+ */
+int col_truncate(col_vec_t * vector, int len);
+
+/**
+ * returns the number of rows in the vector
+ */
+int col_veclen(col_vec_t * vector);
+
+/**
+ * makes sure every column has room for at least capacity rows.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT
+ */
+int col_reserve(col_vec_t * vector, int capacity);
+
+/**
+ * frees all memory given to this vector.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_ALREADY_DESTROYED
+ */
+int col_destroy(col_vec_t * vector);
+
+/**
+ * moves count rows of every column from src to dst, used by COL_VEC_FILTER.
+ * The ranges may overlap.
+ */
+void col_move_rows(col_vec_t * vector, uint32_t dst, uint32_t src, uint32_t count);
+
+//the address of field field of row idx, both must be in range
+#define COL_VEC_AT(vector, field, idx) \
+        ((vector)->columns[field] + (size_t)(idx) * (vector)->fields[field].size)
+
+/**
+ * walks the column of field field. value_ptr is a x * variable, x being the field's
+ * type, that is pointed at the field of each row in turn, and idx is an int variable
+ * set to that row's index. Only the one column is read. Changes made through value_ptr
+ * go straight into the vector. break will work to end early.
+ * Do not add or remove rows from inside the expression.
+ *
+ * Example:
+ *      struct order {
+ *          uint64_t id;
+ *          double price;
+ *          int qty;
+ *      };
+ *
+ *      double * price, total = 0;
+ *      int i;
+ *      COL_VEC_SCAN(vector, 1, price, i, total += *price);
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define COL_VEC_SCAN(vector, field, value_ptr, idx, expression) ({\
+        uint32_t _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            value_ptr = COL_VEC_AT(vector, field, _i);\
+            idx = _i;\
+            expression;\
+        }\
+        VEC_SUCCESS;\
+})
+
+/**
+ * finds the first row whose field field satisfies the condition and sets idx to its index.
+ * value_ptr is a x * variable pointed at each value of the column in turn, and condition
+ * is a boolean expression involving *value_ptr. Only the one column is read; fetch the
+ * rest of the row with col_get once it is found.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ */
+#define COL_VEC_FIND_BY(vector, field, value_ptr, idx, condition) ({\
+        int _ret = VEC_NOT_FOUND;\
+        uint32_t _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            value_ptr = COL_VEC_AT(vector, field, _i);\
+            if (condition) {\
+                idx = _i;\
+                _ret = VEC_SUCCESS;\
+                break;\
+            }\
+        }\
+        _ret;\
+})
+
+/**
+ * keeps only the rows whose field field satisfies the condition, keeping their order.
+ * value_ptr is a x * variable pointed at each value of the column in turn, and condition
+ * is a boolean expression involving *value_ptr. The condition only reads the one column;
+ * every column is then moved in runs of consecutive kept rows, a single pass in all.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define COL_VEC_FILTER(vector, field, value_ptr, condition) ({\
+        uint32_t _i, _keep = 0, _start = 0;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            value_ptr = COL_VEC_AT(vector, field, _i);\
+            if (!(condition)) {\
+                /* the run of kept rows before this one moves down in one go */\
+                col_move_rows(vector, _keep, _start, _i - _start);\
+                _keep += _i - _start;\
+                _start = _i + 1;\
+            }\
+        }\
+        col_move_rows(vector, _keep, _start, (vector)->used_slots - _start);\
+        _keep += (vector)->used_slots - _start;\
+        col_truncate(vector, _keep);\
+})
+#endif
@@ -0,0 +1,118 @@
+#ifndef VEC_STREAM_H
+
+#define VEC_STREAM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "../vec_errors.h"
+
+/**
+ * binary stream format shared by vec_save/vec_load and sync_save/sync_load.
+ *
+ * A stream is a header followed by chunks of elements:
+ *
+ *  header:     "CVECSTR\0", u32 version, u32 flags (0), u64 element_size,
+ *              u64 count hint (how many elements are coming, 0 if unknown)
+ *  chunk:      u32 element count, u32 crc32 of the payload, then the payload itself
+ *  end:        a chunk with a count of 0 and crc of 0, followed by the u64 total element count
+ *
+ * Numbers are stored in the machine's byte order. Chunks are at most
+ * VEC_STREAM_CHUNK_BYTES long (or one element, if elements are bigger), so
+ * writers and readers can move data straight between the fd and a vector's
+ * array without ever holding a full copy.
+ */
+#define VEC_STREAM_VERSION 1
+#define VEC_STREAM_CHUNK_BYTES (1 << 20)
+
+typedef struct {
+    int fd;
+    size_t element_size;
+    uint64_t count;
+} vec_writer_t;
+
+typedef struct {
+    int fd;
+    size_t element_size;
+    uint64_t count_hint;
+    uint64_t count;
+    uint32_t chunk_count;
+    uint32_t chunk_crc;
+    int done;
+} vec_reader_t;
+
+/**
+ * returns the number of elements of element_size that go in one chunk
+ */
+uint32_t vec_stream_chunk_elements(size_t element_size);
+
+/**
+ * updates a running crc32 with len more bytes. Start from 0.
+ */
+uint32_t vec_crc32(uint32_t crc, const void * data, size_t len);
+
+/**
+ * writes the stream header to fd. count_hint is how many elements will be written,
+ * or 0 if not known up front.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ */
+int vec_writer_open(vec_writer_t * writer, int fd, size_t element_size, uint64_t count_hint);
+
+/**
+ * writes count elements straight from the elements array, split into as many chunks as needed.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_NULL_BUFFER
+ */
+int vec_writer_write(vec_writer_t * writer, const void * elements, size_t count);
+
+/**
+ * writes the end of the stream. Does not close fd.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ */
+int vec_writer_close(vec_writer_t * writer);
+
+/**
+ * reads and checks the stream header from fd. Afterwards reader->element_size and
+ * reader->count_hint say what is coming, and both a chunk and count_hint elements
+ * are known to fit in a size_t worth of bytes.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_BAD_FORMAT if the header is not a vector stream's, or its sizes overflow
+ */
+int vec_reader_open(vec_reader_t * reader, int fd);
+
+/**
+ * reads the next chunk's header and sets count to the number of elements in it,
+ * or 0 once the end of the stream was reached and checked.
+ * Every chunk must be read with vec_reader_read_chunk before asking for the next one.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_BAD_FORMAT
+ */
+int vec_reader_next_chunk(vec_reader_t * reader, uint32_t * count);
+
+/**
+ * reads the payload of the chunk announced by vec_reader_next_chunk straight into
+ * buffer, which must have room for count elements, and checks its crc.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_BAD_FORMAT if the crc does not match
+ *  VEC_NULL_BUFFER
+ */
+int vec_reader_read_chunk(vec_reader_t * reader, void * buffer);
+
+#endif
@@ -0,0 +1,174 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lfvec.h"
+
+//published flags sit in front of the elements, padded to a cache line
+#define FLAGS_SIZE(slots) (((slots) + 63) & ~(size_t)63)
+
+static uint32_t segment_slots(int segment) {
+    return (uint32_t)LF_VEC_FIRST_SEGMENT << segment;
+}
+
+//maps an index to its segment and the offset inside it
+static void locate(uint32_t idx, int * segment, uint32_t * offset) {
+    uint64_t p = (uint64_t)idx + LF_VEC_FIRST_SEGMENT;
+    int bit = 63 - __builtin_clzll(p);
+
+    *segment = bit - __builtin_ctz(LF_VEC_FIRST_SEGMENT);
+    *offset = (uint32_t)(p - ((uint64_t)1 << bit));
+}
+
+//returns the segment, allocating it if this is the first append to land in it
+static unsigned char * get_segment(lf_vec_t * vector, int segment) {
+    unsigned char * seg = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+    unsigned char * expected = NULL;
+    size_t slots;
+
+    if (seg != NULL)
+        return seg;
+
+    slots = segment_slots(segment);
+    seg = calloc(1, FLAGS_SIZE(slots) + slots * vector->element_size);
+    if (seg == NULL)
+        return NULL;
+
+    //someone else may have beaten us to it, in which case use theirs
+    if (!atomic_compare_exchange_strong_explicit(&vector->segments[segment], &expected, seg,
+                memory_order_acq_rel, memory_order_acquire)) {
+        free(seg);
+        return expected;
+    }
+
+    return seg;
+}
+
+int lf_init(lf_vec_t * vector, size_t element_size) {
+    //check already initialized
+    if (atomic_load(&vector->segments[0]) != NULL) 
+        return VEC_ALREADY_INITIALIZED;
+
+    vector->element_size = element_size;
+    atomic_store(&vector->reserved_slots, 0);
+
+    //the first segment is always needed, so do not make the first append pay for it
+    if (get_segment(vector, 0) == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    return VEC_SUCCESS;
+}
+
+int lf_append(lf_vec_t * vector, void * element_ptr, int * idx) {
+    unsigned char * seg;
+    uint32_t slot, offset;
+    int segment;
+
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //claim a slot, this is the only point of contention between appenders. The slot's
+    //segment is made to exist first, so a failed append never leaves a claimed slot
+    //behind that would be counted but could never be read
+    slot = atomic_load_explicit(&vector->reserved_slots, memory_order_relaxed);
+    do {
+        if (slot >= INT_MAX)
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+        locate(slot, &segment, &offset);
+        seg = get_segment(vector, segment);
+        if (seg == NULL)
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    } while (!atomic_compare_exchange_weak_explicit(&vector->reserved_slots, &slot, slot + 1,
+                memory_order_relaxed, memory_order_relaxed));
+
+    memcpy(seg + FLAGS_SIZE(segment_slots(segment)) + offset * vector->element_size,
+            element_ptr, vector->element_size);
+
+    //publish, readers that see the flag also see the element
+    atomic_store_explicit((_Atomic unsigned char *)&seg[offset], 1, memory_order_release);
+
+    if (idx != NULL)
+        *idx = slot;
+
+    return VEC_SUCCESS;
+}
+
+int lf_veclen(lf_vec_t * vector) {
+    uint32_t len = atomic_load_explicit(&vector->reserved_slots, memory_order_acquire);
+    return len > INT_MAX ? INT_MAX : (int)len;
+}
+
+int lf_get_ptr(lf_vec_t * vector, int idx, void ** element_ptr) {
+    unsigned char * seg;
+    uint32_t offset;
+    int segment;
+
+    if (element_ptr == NULL) 
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && idx < lf_veclen(vector))) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    locate(idx, &segment, &offset);
+    seg = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+    if (seg == NULL
+            || !atomic_load_explicit((_Atomic unsigned char *)&seg[offset], memory_order_acquire))
+        return VEC_NOT_FOUND;
+
+    *element_ptr = seg + FLAGS_SIZE(segment_slots(segment)) + offset * vector->element_size;
+
+    return VEC_SUCCESS;
+}
+
+int lf_get(lf_vec_t * vector, int idx, void * element_buffer) {
+    void * element;
+    int res;
+
+    if (element_buffer == NULL) 
+        return VEC_NULL_BUFFER;
+
+    res = lf_get_ptr(vector, idx, &element);
+    if (res != VEC_SUCCESS)
+        return res;
+
+    memcpy(element_buffer, element, vector->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int lf_to_array(lf_vec_t * vector, void ** resultptr, int * count) {
+    int i, len = lf_veclen(vector);
+    void * element;
+    void * result = calloc(len > 0 ? len : 1, vector->element_size);
+
+    if (!result)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //stop at the first hole so the result is a prefix of the vector
+    for (i = 0; i < len; i++) {
+        if (lf_get_ptr(vector, i, &element) != VEC_SUCCESS)
+            break;
+        memcpy(result + i * vector->element_size, element, vector->element_size);
+    }
+
+    *resultptr = result;
+    if (count != NULL)
+        *count = i;
+
+    return VEC_SUCCESS;
+}
+
+int lf_destroy(lf_vec_t * vector) {
+    int i;
+
+    if (atomic_load(&vector->segments[0]) == NULL)
+        return VEC_ALREADY_DESTROYED;
+
+    for (i = 0; i < LF_VEC_SEGMENTS; i++)
+        free(atomic_load(&vector->segments[i]));
+
+    memset(vector, 0, sizeof(lf_vec_t));
+
+    return VEC_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#ifndef LFVEC_H
+
+#define LFVEC_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vec_errors.h"
+
+/**
+ * A vector that any number of threads can append to without taking a lock.
+ *
+ * Elements live in segments that are never moved: segment k holds 
+ * LF_VEC_FIRST_SEGMENT << k elements and is allocated the first time
+ * an append lands in it.  Appending makes sure the next slot's segment exists,
+ * reserves the slot with an atomic compare-and-swap, copies the element in and
+ * then marks the slot as published, so readers never block and never see
+ * half written elements.  Growing only allocates the next segment, nothing is
+ * copied and nobody waits.
+ *
+ * Only appends are supported concurrently. lf_destroy must not race with anything.
+ */
+#define LF_VEC_FIRST_SEGMENT 64
+#define LF_VEC_SEGMENTS 27
+
+typedef struct {
+    size_t element_size;
+    _Atomic uint32_t reserved_slots;
+    _Atomic(unsigned char *) segments[LF_VEC_SEGMENTS];
+} lf_vec_t;
+
+/**
+ * given a pointer to a zeroed lf_vec_t struct, and the size of
+ * the elements that will be stored in the vector, initializes the vector.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int lf_init(lf_vec_t * vector, size_t element_size);
+
+/**
+ * appends the item pointed to by the element_ptr to the end of the array
+ * without locking. Safe to call from any number of threads at once.
+ * If idx is not NULL, it is set to the index the element was stored at.
+ * A slot is only taken once its segment is allocated, so an append that fails
+ * leaves nothing behind and every slot counted by lf_veclen gets published.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int lf_append(lf_vec_t * vector, void * element_ptr, int * idx);
+
+/**
+ * returns the number of slots handed out so far. Slots whose append is still
+ * in progress are counted, but cannot be read yet.
+ */
+int lf_veclen(lf_vec_t * vector);
+
+/**
+ * gets the item at the given index and copies it into 
+ * the memory pointed to by element_buffer. Safe to call while other threads append.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ *  VEC_NOT_FOUND if the slot was handed out but its append has not finished yet
+ */
+int lf_get(lf_vec_t * vector, int idx, void * element_buffer);
+
+/**
+ * sets element_ptr to point at the item at the given index. Elements never
+ * move, so the pointer stays valid until lf_destroy.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ *  VEC_NOT_FOUND if the slot was handed out but its append has not finished yet
+ */
+int lf_get_ptr(lf_vec_t * vector, int idx, void ** element_ptr);
+
+/**
+ * copies the published elements at the start of the vector into a new dynamic array, and
+ * sets resultptr to point at it and count to the number of elements copied. Stops at the first
+ * slot whose append has not finished. Free the array with free(*resultptr) when done.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int lf_to_array(lf_vec_t * vector, void ** resultptr, int * count);
+
+/**
+ * frees all memory given to this vector. No other thread may be using it.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_ALREADY_DESTROYED
+ */
+int lf_destroy(lf_vec_t * vector);
+
+/**
+ * Allows you to iterate through the published elements of the vector while other threads append.
+ * vector is a lf_vec_t *, element_ptr is a x * variable that is pointed at each element in turn.
+ * Slots whose append has not finished are skipped. break will work to end early.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define LF_VEC_ITER(vector, element_ptr, expression) ({\
+        int _ret = VEC_SUCCESS;\
+        int _i, _len = lf_veclen(vector);\
+        void * _p;\
+        for (_i = 0; _i < _len; _i++) {\
+            if (lf_get_ptr(vector, _i, &_p) != VEC_SUCCESS)\
+                continue;\
+            element_ptr = _p;\
+            expression;\
+        }\
+        _ret;\
+})
+#endif
@@ -0,0 +1,296 @@
+#include <string.h>
+#include <unistd.h>
+#include "vec_par.h"
+
+//takes chunks of the current job until there are none left
+static void run_chunks(vec_tpool_t * pool) {
+    size_t c, begin, end;
+
+    while ((c = atomic_fetch_add(&pool->next, 1)) < pool->nchunks) {
+        begin = c * pool->chunk;
+        end = begin + pool->chunk < pool->count ? begin + pool->chunk : pool->count;
+        pool->fn(pool->ctx, begin, end);
+    }
+}
+
+static void * worker(void * arg) {
+    vec_tpool_t * pool = arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (pool->generation == seen && !pool->shutdown)
+            pthread_cond_wait(&pool->work, &pool->lock);
+        if (pool->shutdown)
+            break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_chunks(pool);
+
+        //every worker checks in for every job, so none can wander into the next one late
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int vec_tpool_init(vec_tpool_t * pool, int nthreads) {
+    int i;
+
+    if (nthreads <= 0)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (nthreads < 0)
+        nthreads = 0;
+
+    memset(pool, 0, sizeof(vec_tpool_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->submit, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    pool->threads = calloc(nthreads > 0 ? nthreads : 1, sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        vec_tpool_destroy(pool);
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker, pool) != 0) {
+            vec_tpool_destroy(pool);
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+        }
+        pool->nthreads++;
+    }
+
+    return VEC_SUCCESS;
+}
+
+int vec_tpool_run(vec_tpool_t * pool, size_t count, size_t chunk,
+        void (*fn)(void * ctx, size_t begin, size_t end), void * ctx) {
+    if (count == 0)
+        return VEC_SUCCESS;
+    if (chunk == 0)
+        chunk = 1;
+
+    pthread_mutex_lock(&pool->submit);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->chunk = chunk;
+    pool->nchunks = (count + chunk - 1) / chunk;
+    atomic_store(&pool->next, 0);
+    pool->pending = pool->nthreads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_chunks(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->submit);
+
+    return VEC_SUCCESS;
+}
+
+int vec_tpool_destroy(vec_tpool_t * pool) {
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->submit);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+    memset(pool, 0, sizeof(vec_tpool_t));
+
+    return VEC_SUCCESS;
+}
+
+static vec_tpool_t default_pool;
+static int default_ok;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static void default_init(void) {
+    default_ok = vec_tpool_init(&default_pool, 0) == VEC_SUCCESS;
+}
+
+vec_tpool_t * vec_tpool_default(void) {
+    pthread_once(&default_once, default_init);
+    return default_ok ? &default_pool : NULL;
+}
+
+static size_t chunk_elements(size_t element_size) {
+    size_t chunk = VEC_PAR_CHUNK_BYTES / (element_size > 0 ? element_size : 1);
+    return chunk > 1024 ? chunk : 1024;
+}
+
+//whether to bother the pool at all, and which one
+static vec_tpool_t * pool_for(size_t count) {
+    vec_tpool_t * pool;
+
+    if (count < VEC_PAR_MIN)
+        return NULL;
+
+    pool = vec_tpool_default();
+    return pool != NULL && pool->nthreads > 0 ? pool : NULL;
+}
+
+typedef struct {
+    const void * src;
+    size_t element_size;
+    void * dst;
+    size_t dst_element_size;
+    vec_map_fn fn;
+    void * ctx;
+} map_job_t;
+
+static void map_range(void * arg, size_t begin, size_t end) {
+    map_job_t * job = arg;
+    size_t i;
+
+    for (i = begin; i < end; i++)
+        job->fn(job->src + i * job->element_size, job->dst + i * job->dst_element_size, job->ctx);
+}
+
+int vec_par_map(const void * src, size_t count, size_t element_size,
+        void * dst, size_t dst_element_size, vec_map_fn fn, void * ctx) {
+    map_job_t job = {src, element_size, dst, dst_element_size, fn, ctx};
+    vec_tpool_t * pool = pool_for(count);
+
+    if (pool == NULL) {
+        map_range(&job, 0, count);
+        return VEC_SUCCESS;
+    }
+
+    return vec_tpool_run(pool, count, chunk_elements(element_size), map_range, &job);
+}
+
+typedef struct {
+    void * array;
+    size_t element_size;
+    size_t chunk;
+    size_t * kept;
+    vec_pred_fn pred;
+    void * ctx;
+} filter_job_t;
+
+//slides the kept elements of one chunk to the front of that chunk
+static void filter_range(void * arg, size_t begin, size_t end) {
+    filter_job_t * job = arg;
+    size_t es = job->element_size;
+    size_t i, keep = begin;
+
+    for (i = begin; i < end; i++) {
+        if (job->pred(job->array + i * es, job->ctx)) {
+            if (keep != i)
+                memcpy(job->array + keep * es, job->array + i * es, es);
+            keep++;
+        }
+    }
+
+    job->kept[begin / job->chunk] = keep - begin;
+}
+
+int vec_par_filter(void * array, size_t count, size_t element_size,
+        vec_pred_fn pred, void * ctx, size_t * kept) {
+    filter_job_t job = {array, element_size, 0, NULL, pred, ctx};
+    vec_tpool_t * pool = pool_for(count);
+    size_t c, nchunks, total;
+
+    if (pool == NULL) {
+        job.chunk = count > 0 ? count : 1;
+        job.kept = kept;
+        filter_range(&job, 0, count);
+        return VEC_SUCCESS;
+    }
+
+    job.chunk = chunk_elements(element_size);
+    nchunks = (count + job.chunk - 1) / job.chunk;
+    job.kept = malloc(nchunks * sizeof(size_t));
+    if (job.kept == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    vec_tpool_run(pool, count, job.chunk, filter_range, &job);
+
+    //pack the chunks together. Each one only ever moves down, in order, so the
+    //moves are done one after another; the predicate calls were the costly part
+    total = job.kept[0];
+    for (c = 1; c < nchunks; c++) {
+        memmove(array + total * element_size, array + c * job.chunk * element_size, job.kept[c] * element_size);
+        total += job.kept[c];
+    }
+
+    free(job.kept);
+    *kept = total;
+
+    return VEC_SUCCESS;
+}
+
+typedef struct {
+    const void * array;
+    size_t element_size;
+    size_t chunk;
+    void * accs;
+    size_t result_size;
+    vec_reduce_fn fn;
+    void * ctx;
+} reduce_job_t;
+
+static void reduce_range(void * arg, size_t begin, size_t end) {
+    reduce_job_t * job = arg;
+    void * acc = job->accs + (begin / job->chunk) * job->result_size;
+    size_t i;
+
+    for (i = begin; i < end; i++)
+        job->fn(acc, job->array + i * job->element_size, job->ctx);
+}
+
+int vec_par_reduce(const void * array, size_t count, size_t element_size,
+        void * result, size_t result_size, vec_reduce_fn fn, vec_combine_fn combine, void * ctx) {
+    reduce_job_t job = {array, element_size, 0, NULL, result_size, fn, ctx};
+    vec_tpool_t * pool = pool_for(count);
+    size_t c, nchunks;
+
+    if (pool == NULL) {
+        job.chunk = count > 0 ? count : 1;
+        job.accs = result;
+        reduce_range(&job, 0, count);
+        return VEC_SUCCESS;
+    }
+
+    job.chunk = chunk_elements(element_size);
+    nchunks = (count + job.chunk - 1) / job.chunk;
+    job.accs = malloc(nchunks * result_size);
+    if (job.accs == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //every chunk starts from the identity value the caller left in result
+    for (c = 0; c < nchunks; c++)
+        memcpy(job.accs + c * result_size, result, result_size);
+
+    vec_tpool_run(pool, count, job.chunk, reduce_range, &job);
+
+    for (c = 0; c < nchunks; c++)
+        combine(result, job.accs + c * result_size, ctx);
+
+    free(job.accs);
+
+    return VEC_SUCCESS;
+}
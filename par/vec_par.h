@@ -0,0 +1,125 @@
+#ifndef VEC_PAR_H
+
+#define VEC_PAR_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../vec_errors.h"
+#include "../vec_types.h"
+
+/**
+ * a persistent pool of worker threads for data parallel loops. The threads are
+ * started once and sleep between jobs, so a parallel loop only costs a wakeup
+ * instead of creating and joining threads. One job runs at a time; the thread
+ * that submits it works on it too.
+ */
+typedef struct {
+    pthread_t * threads;
+    int nthreads;
+    pthread_mutex_t lock;
+    pthread_mutex_t submit;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    uint64_t generation;
+    int pending;
+    int shutdown;
+    //the current job
+    void (*fn)(void * ctx, size_t begin, size_t end);
+    void * ctx;
+    size_t count;
+    size_t chunk;
+    size_t nchunks;
+    _Atomic size_t next;
+} vec_tpool_t;
+
+/**
+ * arrays shorter than this are handled by the calling thread alone, waking the
+ * pool would cost more than it saves
+ */
+#define VEC_PAR_MIN 32768
+
+/**
+ * work is handed out in chunks of about this many bytes, small enough to stay
+ * in cache and balance the load, large enough to keep the hand out cheap
+ */
+#define VEC_PAR_CHUNK_BYTES (256 * 1024)
+
+/**
+ * starts a pool with nthreads workers besides the thread that submits jobs.
+ * nthreads <= 0 starts one less than the number of online cpus.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int vec_tpool_init(vec_tpool_t * pool, int nthreads);
+
+/**
+ * calls fn(ctx, begin, end) for ranges of at most chunk items that together cover [0, count),
+ * spread over the pool and the calling thread, and returns once all of them are done.
+ * Calls from several threads at once are run one after another.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_tpool_run(vec_tpool_t * pool, size_t count, size_t chunk,
+        void (*fn)(void * ctx, size_t begin, size_t end), void * ctx);
+
+/**
+ * stops and joins the workers.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_tpool_destroy(vec_tpool_t * pool);
+
+/**
+ * the pool the vec_par_* functions use, started with one worker per cpu but one
+ * on first use and kept for the life of the process. NULL if it could not be started.
+ */
+vec_tpool_t * vec_tpool_default(void);
+
+/**
+ * the array level parallel operations behind vec_parallel_map, vec_parallel_filter
+ * and vec_parallel_reduce and their sync_ versions. All of them run on the default
+ * pool, fall back to a plain loop below VEC_PAR_MIN elements, and keep the order of
+ * the elements.
+ */
+
+/**
+ * calls fn on each of the count elements of src, writing the results to the same
+ * positions of dst.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_par_map(const void * src, size_t count, size_t element_size,
+        void * dst, size_t dst_element_size, vec_map_fn fn, void * ctx);
+
+/**
+ * keeps the elements of array pred returns true for at the front of the array,
+ * in their original order, and sets kept to how many there are.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int vec_par_filter(void * array, size_t count, size_t element_size,
+        vec_pred_fn pred, void * ctx, size_t * kept);
+
+/**
+ * folds every element into result with fn. result must hold the identity value for
+ * the reduction on entry: each chunk starts from a copy of it, and the chunk results
+ * are folded into result with combine from left to right, so fn and combine must be
+ * associative but need not be commutative.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int vec_par_reduce(const void * array, size_t count, size_t element_size,
+        void * result, size_t result_size, vec_reduce_fn fn, vec_combine_fn combine, void * ctx);
+
+#endif
@@ -0,0 +1,252 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ring.h"
+
+#define MIN_SIZE 64
+#define MAX_SLOTS ((uint32_t)1 << 31)
+
+//the smallest power of two that holds count elements
+static uint32_t round_slots(uint32_t count) {
+    uint32_t slots = 1;
+
+    while (slots < count)
+        slots <<= 1;
+
+    return slots;
+}
+
+//copies the elements in order to dst, undoing the wrap around
+static void copy_out(ring_t * ring, void * dst) {
+    uint32_t first = ring->allocated_slots - ring->head;
+
+    if (first > ring->used_slots)
+        first = ring->used_slots;
+
+    memcpy(dst, ring->array + (size_t)ring->head * ring->element_size, (size_t)first * ring->element_size);
+    memcpy(dst + (size_t)first * ring->element_size, ring->array, (size_t)(ring->used_slots - first) * ring->element_size);
+}
+
+//grows the buffer to new_slots, a larger power of two, keeping the elements in place where possible
+static int grow_to(ring_t * ring, uint32_t new_slots) {
+    uint32_t old_slots = ring->allocated_slots;
+    uint32_t wrapped;
+    void * tmp = vec_mem_realloc(ring->allocator, ring->array,
+            (size_t)old_slots * ring->element_size,
+            (size_t)new_slots * ring->element_size);
+    if (tmp == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    ring->array = tmp;
+    ring->allocated_slots = new_slots;
+
+    //the part that wrapped to the start now belongs right after the old end,
+    //which always has room since the buffer at least doubled
+    if (ring->head + ring->used_slots > old_slots) {
+        wrapped = ring->head + ring->used_slots - old_slots;
+        memcpy(ring->array + (size_t)old_slots * ring->element_size, ring->array, (size_t)wrapped * ring->element_size);
+    }
+
+    return VEC_SUCCESS;
+}
+
+static int make_room(ring_t * ring) {
+    if (ring->used_slots < ring->allocated_slots)
+        return VEC_SUCCESS;
+
+    if (ring->allocated_slots >= MAX_SLOTS)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    return grow_to(ring, ring->allocated_slots * 2);
+}
+
+int ring_init(ring_t * ring, size_t element_size) {
+    return ring_init_with_capacity(ring, element_size, MIN_SIZE);
+}
+
+int ring_init_with_capacity(ring_t * ring, size_t element_size, int capacity) {
+    //check already initialized
+    if (ring->array != NULL && ring->allocated_slots > 0)
+        return VEC_ALREADY_INITIALIZED;
+
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    ring->element_size = element_size;
+    ring->used_slots = 0;
+    ring->head = 0;
+
+    ring->allocated_slots = round_slots(capacity);
+    ring->array = vec_mem_alloc(ring->allocator, (size_t)ring->allocated_slots * element_size);
+
+    //check memory allocation
+    if (ring->array == NULL) {
+        ring->allocated_slots = 0;
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
+
+    return VEC_SUCCESS;
+}
+
+int ring_init_with_allocator(ring_t * ring, size_t element_size, int capacity, const vec_allocator_t * allocator) {
+    //check already initialized
+    if (ring->array != NULL && ring->allocated_slots > 0)
+        return VEC_ALREADY_INITIALIZED;
+
+    ring->allocator = allocator;
+    return ring_init_with_capacity(ring, element_size, capacity);
+}
+
+int ring_push_back(ring_t * ring, void * element_ptr) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (make_room(ring))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    memcpy(RING_AT(ring, ring->used_slots), element_ptr, ring->element_size);
+    ring->used_slots++;
+
+    return VEC_SUCCESS;
+}
+
+int ring_push_front(ring_t * ring, void * element_ptr) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (make_room(ring))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //step head back one slot, wrapping to the end of the array
+    ring->head = (ring->head - 1) & (ring->allocated_slots - 1);
+    ring->used_slots++;
+    memcpy(RING_AT(ring, 0), element_ptr, ring->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int ring_pop_back(ring_t * ring, void * element_buffer) {
+    if (ring->used_slots == 0)
+        return VEC_NOT_FOUND;
+
+    ring->used_slots--;
+    if (element_buffer != NULL)
+        memcpy(element_buffer, RING_AT(ring, ring->used_slots), ring->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int ring_pop_front(ring_t * ring, void * element_buffer) {
+    if (ring->used_slots == 0)
+        return VEC_NOT_FOUND;
+
+    if (element_buffer != NULL)
+        memcpy(element_buffer, RING_AT(ring, 0), ring->element_size);
+
+    ring->head = (ring->head + 1) & (ring->allocated_slots - 1);
+    ring->used_slots--;
+
+    //an empty ring starts over at slot 0, which keeps a queue that keeps
+    //draining completely from ever wrapping
+    if (ring->used_slots == 0)
+        ring->head = 0;
+
+    return VEC_SUCCESS;
+}
+
+int ring_get(ring_t * ring, int idx, void * element_buffer) {
+    if (element_buffer == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < ring->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    memcpy(element_buffer, RING_AT(ring, idx), ring->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int ring_get_ptr(ring_t * ring, int idx, void ** element_ptr) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < ring->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    *element_ptr = RING_AT(ring, idx);
+
+    return VEC_SUCCESS;
+}
+
+int ring_replace(ring_t * ring, void * element_ptr, int idx) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < ring->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    memcpy(RING_AT(ring, idx), element_ptr, ring->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int ring_len(ring_t * ring) {
+    return ring->used_slots;
+}
+
+int ring_reserve(ring_t * ring, int capacity) {
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    if ((uint32_t)capacity <= ring->allocated_slots)
+        return VEC_SUCCESS;
+
+    return grow_to(ring, round_slots(capacity));
+}
+
+int ring_shrink_to_fit(ring_t * ring) {
+    uint32_t new_slots = round_slots(ring->used_slots);
+    void * tmp;
+
+    if (new_slots == ring->allocated_slots)
+        return VEC_SUCCESS;
+
+    //the elements may wrap, so copy them out in order rather than realloc
+    tmp = vec_mem_alloc(ring->allocator, (size_t)new_slots * ring->element_size);
+    if (tmp == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    copy_out(ring, tmp);
+    vec_mem_free(ring->allocator, ring->array, (size_t)ring->allocated_slots * ring->element_size);
+
+    ring->array = tmp;
+    ring->allocated_slots = new_slots;
+    ring->head = 0;
+
+    return VEC_SUCCESS;
+}
+
+int ring_to_array(ring_t * ring, void ** resultptr) {
+    //always hand back a real allocation, even for an empty ring
+    void * result = calloc(ring->used_slots > 0 ? ring->used_slots : 1, ring->element_size);
+
+    if (result == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    copy_out(ring, result);
+    *resultptr = result;
+
+    return VEC_SUCCESS;
+}
+
+int ring_destroy(ring_t * ring) {
+    if (ring->array == NULL)
+        return VEC_ALREADY_DESTROYED;
+
+    vec_mem_free(ring->allocator, ring->array, (size_t)ring->allocated_slots * ring->element_size);
+    memset(ring, 0, sizeof(ring_t));
+
+    return VEC_SUCCESS;
+}
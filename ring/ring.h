@@ -0,0 +1,206 @@
+#ifndef RING_H
+
+#define RING_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vec_errors.h"
+#include "../alloc/vec_alloc.h"
+
+/**
+ * A vector that is a circular buffer, so elements can be pushed and popped at
+ * both ends in O(1), for queues and deques.
+ *
+ * The elements are the used_slots slots starting at head, wrapping around the
+ * end of the array. allocated_slots is always a power of two so a logical index
+ * maps to its slot with a mask. The buffer doubles when full and never shrinks
+ * on its own, since a queue that drains usually fills up again; ring_shrink_to_fit
+ * gives the memory back.
+ */
+typedef struct {
+    uint32_t allocated_slots;
+    uint32_t used_slots;
+    uint32_t head;
+    size_t element_size;
+    void * array;
+    const vec_allocator_t * allocator;
+} ring_t;
+
+/**
+ * given a pointer to a zeroed ring_t struct, and the size of
+ * the elements that will be stored in it, initializes the ring with some memory.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int ring_init(ring_t * ring, size_t element_size);
+
+/**
+ * same as ring_init, but allocates room for at least capacity elements up front,
+ * rounded up to a power of two.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int ring_init_with_capacity(ring_t * ring, size_t element_size, int capacity);
+
+/**
+ * same as ring_init_with_capacity, but all of the ring's memory comes from allocator
+ * instead of calloc/realloc/free. allocator must outlive the ring. See alloc/vec_alloc.h
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int ring_init_with_allocator(ring_t * ring, size_t element_size, int capacity, const vec_allocator_t * allocator);
+
+/**
+ * adds the item pointed to by element_ptr after the last element,
+ * doubling the buffer if it is full.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int ring_push_back(ring_t * ring, void * element_ptr);
+
+/**
+ * adds the item pointed to by element_ptr before the first element,
+ * so it becomes index 0, doubling the buffer if it is full.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int ring_push_front(ring_t * ring, void * element_ptr);
+
+/**
+ * removes the last element and copies it into element_buffer.
+ * element_buffer may be NULL to just drop the element.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND if the ring is empty
+ */
+int ring_pop_back(ring_t * ring, void * element_buffer);
+
+/**
+ * removes the first element and copies it into element_buffer, everything
+ * else moves down one index without being moved in memory.
+ * element_buffer may be NULL to just drop the element.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND if the ring is empty
+ */
+int ring_pop_front(ring_t * ring, void * element_buffer);
+
+/**
+ * gets the item at the given logical index, 0 being the front, and copies it into
+ * the memory pointed to by element_buffer
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int ring_get(ring_t * ring, int idx, void * element_buffer);
+
+/**
+ * sets element_ptr to point at the item at the given logical index. The pointer
+ * is only good until the next push or ring_reserve/ring_shrink_to_fit.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int ring_get_ptr(ring_t * ring, int idx, void ** element_ptr);
+
+/**
+ * overwrites the item at the given logical index with the one element_ptr points to
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int ring_replace(ring_t * ring, void * element_ptr, int idx);
+
+/**
+ * returns the number of elements in the ring
+ */
+int ring_len(ring_t * ring);
+
+/**
+ * makes sure there is room for at least capacity elements, rounded up to a power
+ * of two, so that many pushes never reallocate.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT
+ */
+int ring_reserve(ring_t * ring, int capacity);
+
+/**
+ * moves the elements into the smallest power of two buffer that holds them,
+ * starting at slot 0.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int ring_shrink_to_fit(ring_t * ring);
+
+/**
+ * copies the elements, front first, into a new dynamic array and sets resultptr
+ * to point at it. Free the array with free(*resultptr) when done.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int ring_to_array(ring_t * ring, void ** resultptr);
+
+/**
+ * frees all memory given to this ring.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_ALREADY_DESTROYED
+ */
+int ring_destroy(ring_t * ring);
+
+//the address of the element at logical index idx, which must be in bounds
+#define RING_AT(ring, idx) ((ring)->array + \
+        (((ring)->head + (uint32_t)(idx)) & ((ring)->allocated_slots - 1)) * (ring)->element_size)
+
+/**
+ * Allows you to iterate through the ring front to back.
+ * ring is a ring_t *, element_ptr is a x * variable that is pointed at each element in turn,
+ * so changes made through it stay in the ring. break will work to end early.
+ * Do not push or pop from inside the expression.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define RING_ITER(ring, element_ptr, expression) ({\
+        unsigned int _i;\
+        for (_i = 0; _i < (ring)->used_slots; _i++) {\
+            element_ptr = RING_AT(ring, _i);\
+            expression;\
+        }\
+        VEC_SUCCESS;\
+})
+#endif
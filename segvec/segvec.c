@@ -0,0 +1,225 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "segvec.h"
+
+//maps an index to its segment and the offset inside it
+static void locate(uint32_t idx, int * segment, uint32_t * offset) {
+    uint64_t p = (uint64_t)idx + SEG_VEC_FIRST_SEGMENT;
+    int bit = 63 - __builtin_clzll(p);
+
+    *segment = bit - __builtin_ctz(SEG_VEC_FIRST_SEGMENT);
+    *offset = (uint32_t)(p - ((uint64_t)1 << bit));
+}
+
+static void * element_at(seg_vec_t * vector, uint32_t idx) {
+    uint32_t offset;
+    int segment;
+
+    locate(idx, &segment, &offset);
+    return vector->segments[segment] + (size_t)offset * vector->element_size;
+}
+
+//allocates segments until slot idx exists. Segments are only ever added at the end
+static int ensure_slot(seg_vec_t * vector, uint32_t idx) {
+    uint32_t offset;
+    int segment, k;
+
+    if (idx < vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    locate(idx, &segment, &offset);
+    for (k = 0; k <= segment; k++) {
+        if (vector->segments[k] != NULL)
+            continue;
+        vector->segments[k] = vec_mem_alloc(vector->allocator, (size_t)SEG_VEC_SEGMENT_SLOTS(k) * vector->element_size);
+        if (vector->segments[k] == NULL)
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+        vector->allocated_slots += SEG_VEC_SEGMENT_SLOTS(k);
+    }
+
+    return VEC_SUCCESS;
+}
+
+int seg_init(seg_vec_t * vector, size_t element_size) {
+    //check already initialized
+    if (vector->segments[0] != NULL)
+        return VEC_ALREADY_INITIALIZED;
+
+    vector->element_size = element_size;
+    vector->used_slots = 0;
+    vector->allocated_slots = 0;
+
+    //the first segment is always needed, so do not make the first append pay for it
+    return ensure_slot(vector, 0);
+}
+
+int seg_init_with_allocator(seg_vec_t * vector, size_t element_size, const vec_allocator_t * allocator) {
+    //check already initialized
+    if (vector->segments[0] != NULL)
+        return VEC_ALREADY_INITIALIZED;
+
+    vector->allocator = allocator;
+    return seg_init(vector, element_size);
+}
+
+int seg_append(seg_vec_t * vector, void * element_ptr) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (vector->used_slots >= INT_MAX || ensure_slot(vector, vector->used_slots))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    memcpy(element_at(vector, vector->used_slots), element_ptr, vector->element_size);
+    vector->used_slots++;
+
+    return VEC_SUCCESS;
+}
+
+int seg_append_n(seg_vec_t * vector, void * elements, int count) {
+    uint32_t offset, n;
+    int segment;
+
+    if (elements == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (count < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    if ((uint64_t)vector->used_slots + count > INT_MAX)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //fill the rest of each segment with one copy
+    while (count > 0) {
+        if (ensure_slot(vector, vector->used_slots))
+            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+        locate(vector->used_slots, &segment, &offset);
+        n = SEG_VEC_SEGMENT_SLOTS(segment) - offset;
+        if (n > (uint32_t)count)
+            n = count;
+
+        memcpy(vector->segments[segment] + (size_t)offset * vector->element_size, elements, (size_t)n * vector->element_size);
+        elements += (size_t)n * vector->element_size;
+        vector->used_slots += n;
+        count -= n;
+    }
+
+    return VEC_SUCCESS;
+}
+
+int seg_get_ptr(seg_vec_t * vector, int idx, void ** element_ptr) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    *element_ptr = element_at(vector, idx);
+
+    return VEC_SUCCESS;
+}
+
+int seg_get(seg_vec_t * vector, int idx, void * element_buffer) {
+    if (element_buffer == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    memcpy(element_buffer, element_at(vector, idx), vector->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int seg_replace(seg_vec_t * vector, void * element_ptr, int idx) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    memcpy(element_at(vector, idx), element_ptr, vector->element_size);
+
+    return VEC_SUCCESS;
+}
+
+int seg_veclen(seg_vec_t * vector) {
+    return vector->used_slots;
+}
+
+int seg_truncate(seg_vec_t * vector, int len) {
+    //check bounds
+    if (!(len >= 0 && (uint32_t)len <= vector->used_slots))
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    vector->used_slots = len;
+
+    return VEC_SUCCESS;
+}
+
+int seg_reserve(seg_vec_t * vector, int capacity) {
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    if (capacity == 0)
+        return VEC_SUCCESS;
+
+    return ensure_slot(vector, capacity - 1);
+}
+
+int seg_shrink_to_fit(seg_vec_t * vector) {
+    uint32_t offset;
+    int segment, k;
+
+    //keep the segment holding the last element, or the first one if empty
+    locate(vector->used_slots > 0 ? vector->used_slots - 1 : 0, &segment, &offset);
+
+    for (k = segment + 1; k < SEG_VEC_SEGMENTS && vector->segments[k] != NULL; k++) {
+        vec_mem_free(vector->allocator, vector->segments[k], (size_t)SEG_VEC_SEGMENT_SLOTS(k) * vector->element_size);
+        vector->segments[k] = NULL;
+        vector->allocated_slots -= SEG_VEC_SEGMENT_SLOTS(k);
+    }
+
+    return VEC_SUCCESS;
+}
+
+int seg_to_array(seg_vec_t * vector, void ** resultptr) {
+    void * result = calloc(vector->used_slots > 0 ? vector->used_slots : 1, vector->element_size);
+    uint32_t copied = 0, n;
+    int k;
+
+    if (!result)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //one copy per segment
+    for (k = 0; copied < vector->used_slots; k++) {
+        n = SEG_VEC_SEGMENT_SLOTS(k);
+        if (n > vector->used_slots - copied)
+            n = vector->used_slots - copied;
+        memcpy(result + (size_t)copied * vector->element_size, vector->segments[k], (size_t)n * vector->element_size);
+        copied += n;
+    }
+
+    *resultptr = result;
+
+    return VEC_SUCCESS;
+}
+
+int seg_destroy(seg_vec_t * vector) {
+    int k;
+
+    if (vector->segments[0] == NULL)
+        return VEC_ALREADY_DESTROYED;
+
+    for (k = 0; k < SEG_VEC_SEGMENTS; k++)
+        if (vector->segments[k] != NULL)
+            vec_mem_free(vector->allocator, vector->segments[k], (size_t)SEG_VEC_SEGMENT_SLOTS(k) * vector->element_size);
+
+    memset(vector, 0, sizeof(seg_vec_t));
+
+    return VEC_SUCCESS;
+}
@@ -0,0 +1,216 @@
+#ifndef SEGVEC_H
+
+#define SEGVEC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vec_errors.h"
+#include "../alloc/vec_alloc.h"
+
+/**
+ * A vector that never moves its elements.
+ *
+ * Elements live in segments behind a small table, like lf_vec_t: segment k holds
+ * SEG_VEC_FIRST_SEGMENT << k elements and is allocated when the vector first needs it.
+ * Growing only allocates the next segment, so there is no realloc, no copy of what is
+ * already stored and never two copies of the data in memory at once, and pointers from
+ * seg_get_ptr stay valid until the element is removed or the vector destroyed.
+ * Since the segments double, at most half of the allocation is unused, as with vec_t.
+ *
+ * Elements can only be added and removed at the end, anything else would have to move them.
+ */
+#define SEG_VEC_FIRST_SEGMENT 64
+#define SEG_VEC_SEGMENTS 26
+
+//number of elements segment k holds
+#define SEG_VEC_SEGMENT_SLOTS(k) ((uint32_t)SEG_VEC_FIRST_SEGMENT << (k))
+
+typedef struct {
+    uint32_t used_slots;
+    uint32_t allocated_slots;
+    size_t element_size;
+    void * segments[SEG_VEC_SEGMENTS];
+    const vec_allocator_t * allocator;
+} seg_vec_t;
+
+/**
+ * given a pointer to a zeroed seg_vec_t struct, and the size of
+ * the elements that will be stored in the vector, initializes the vector
+ * with its first segment.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int seg_init(seg_vec_t * vector, size_t element_size);
+
+/**
+ * same as seg_init, but every segment comes from allocator instead of calloc/free.
+ * allocator must outlive the vector. Segments are never reallocated. See alloc/vec_alloc.h
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int seg_init_with_allocator(seg_vec_t * vector, size_t element_size, const vec_allocator_t * allocator);
+
+/**
+ * appends the item pointed to by element_ptr to the end of the vector,
+ * allocating a new segment if the last one is full. Nothing already stored moves.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int seg_append(seg_vec_t * vector, void * element_ptr);
+
+/**
+ * appends count items from the elements array, copying a whole segment's worth at a time.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ *  VEC_INVALID_ARGUMENT if count is negative
+ */
+int seg_append_n(seg_vec_t * vector, void * elements, int count);
+
+/**
+ * gets the item at the given index and copies it into
+ * the memory pointed to by element_buffer
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int seg_get(seg_vec_t * vector, int idx, void * element_buffer);
+
+/**
+ * sets element_ptr to point at the item at the given index. Elements never
+ * move, so the pointer stays valid until the element is removed with seg_truncate
+ * or the vector is destroyed, no matter how much is appended meanwhile.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int seg_get_ptr(seg_vec_t * vector, int idx, void ** element_ptr);
+
+/**
+ * overwrites the item at the given index with the one element_ptr points to
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int seg_replace(seg_vec_t * vector, void * element_ptr, int idx);
+
+/**
+ * returns the current length of the vector
+ */
+int seg_veclen(seg_vec_t * vector);
+
+/**
+ * removes every element from position len on. The segments stay allocated
+ * for the next appends, seg_shrink_to_fit frees the ones left empty.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS if len is negative or larger than the vector
+ */
+int seg_truncate(seg_vec_t * vector, int len);
+
+/**
+ * allocates segments until there is room for capacity elements,
+ * so that many appends never allocate.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT
+ */
+int seg_reserve(seg_vec_t * vector, int capacity);
+
+/**
+ * frees every segment past the one holding the last element, always keeping the first.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int seg_shrink_to_fit(seg_vec_t * vector);
+
+/**
+ * copies the vector into a new dynamic array and sets resultptr to point at it.
+ * Free the array with free(*resultptr) when done.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int seg_to_array(seg_vec_t * vector, void ** resultptr);
+
+/**
+ * frees all memory given to this vector.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_ALREADY_DESTROYED
+ */
+int seg_destroy(seg_vec_t * vector);
+
+/**
+ * Allows you to iterate through the vector more easily.
+ * vector is a seg_vec_t *, element_buffer is a x *, where x is the type being stored.
+ * expression is any code you choose to execute, that will have the variable *element_buffer
+ * availible and filled out with a given element, which is copied back afterwards.
+ * break will work to end early. Do not add or remove elements from inside the expression.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define SEG_VEC_ITER(vector, element_buffer, expression) ({\
+        uint32_t _i, _off = 0;\
+        int _seg = 0;\
+        void * _p;\
+        for (_i = 0; _i < (vector)->used_slots; _i++, _off++) {\
+            if (_off == SEG_VEC_SEGMENT_SLOTS(_seg)) {\
+                _seg++;\
+                _off = 0;\
+            }\
+            _p = (vector)->segments[_seg] + (size_t)_off * (vector)->element_size;\
+            memcpy(element_buffer, _p, (vector)->element_size);\
+            expression;\
+            memcpy(_p, element_buffer, (vector)->element_size);\
+        }\
+        VEC_SUCCESS;\
+})
+
+/**
+ * same as SEG_VEC_ITER, but element_ptr is a x * variable that is pointed at each element
+ * in turn. Changes made through element_ptr go straight into the vector. The walk goes
+ * segment by segment, there is no index lookup per element. break will work to end early.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define SEG_VEC_ITER_PTR(vector, element_ptr, expression) ({\
+        uint32_t _i, _off = 0;\
+        int _seg = 0;\
+        for (_i = 0; _i < (vector)->used_slots; _i++, _off++) {\
+            if (_off == SEG_VEC_SEGMENT_SLOTS(_seg)) {\
+                _seg++;\
+                _off = 0;\
+            }\
+            element_ptr = (vector)->segments[_seg] + (size_t)_off * (vector)->element_size;\
+            expression;\
+        }\
+        VEC_SUCCESS;\
+})
+#endif
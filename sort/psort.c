@@ -0,0 +1,202 @@
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "psort.h"
+
+typedef int (*cmpfn)(const void*,const void*);
+
+typedef struct {
+    void * base;
+    size_t count;
+    size_t element_size;
+    cmpfn cmp;
+} run_job_t;
+
+//one slice of the merge of a and b into out, covering output positions [begin, end)
+typedef struct {
+    const void * a;
+    size_t na;
+    const void * b;
+    size_t nb;
+    void * out;
+    size_t begin;
+    size_t end;
+    size_t element_size;
+    cmpfn cmp;
+} merge_job_t;
+
+static inline void copy_element(void * dst, const void * src, size_t element_size) {
+    //let the compiler turn the common sizes into plain loads and stores
+    switch (element_size) {
+        case 4: memcpy(dst, src, 4); break;
+        case 8: memcpy(dst, src, 8); break;
+        case 16: memcpy(dst, src, 16); break;
+        default: memcpy(dst, src, element_size); break;
+    }
+}
+
+static void * run_sort(void * arg) {
+    run_job_t * job = arg;
+    qsort(job->base, job->count, job->element_size, job->cmp);
+    return NULL;
+}
+
+/*
+ * how many elements of a come before output position d. Found by binary search
+ * along the diagonal, so each merge slice can start without looking at the others.
+ * Ties go to a, the same as in merge_range.
+ */
+static size_t co_rank(const merge_job_t * job, size_t d) {
+    size_t lo = d > job->nb ? d - job->nb : 0;
+    size_t hi = d < job->na ? d : job->na;
+    size_t mid;
+    size_t es = job->element_size;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (job->cmp(job->b + (d - mid - 1) * es, job->a + mid * es) >= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static void * merge_range(void * arg) {
+    merge_job_t * job = arg;
+    size_t es = job->element_size;
+    size_t i = co_rank(job, job->begin);
+    size_t j = job->begin - i;
+    size_t i_end = co_rank(job, job->end);
+    size_t j_end = job->end - i_end;
+    void * out = job->out + job->begin * es;
+
+    while (i < i_end && j < j_end) {
+        if (job->cmp(job->a + i * es, job->b + j * es) <= 0) {
+            copy_element(out, job->a + i * es, es);
+            i++;
+        } else {
+            copy_element(out, job->b + j * es, es);
+            j++;
+        }
+        out += es;
+    }
+
+    //one side ran out, the rest of the other is already in order
+    if (i < i_end)
+        memcpy(out, job->a + i * es, (i_end - i) * es);
+    else if (j < j_end)
+        memcpy(out, job->b + j * es, (j_end - j) * es);
+
+    return NULL;
+}
+
+//runs every job, each on its own thread except the last which the caller runs
+static void run_all(void * (*fn)(void *), void * jobs, size_t job_size, int njobs) {
+    pthread_t threads[PSORT_MAX_THREADS];
+    int started[PSORT_MAX_THREADS];
+    int i;
+
+    for (i = 0; i < njobs - 1; i++) {
+        started[i] = pthread_create(&threads[i], NULL, fn, jobs + i * job_size) == 0;
+        //out of threads, do it here instead
+        if (!started[i])
+            fn(jobs + i * job_size);
+    }
+    fn(jobs + (njobs - 1) * job_size);
+
+    for (i = 0; i < njobs - 1; i++)
+        if (started[i])
+            pthread_join(threads[i], NULL);
+}
+
+int vec_psort(void * base, size_t count, size_t element_size,
+        cmpfn cmp, int nthreads, const vec_allocator_t * allocator) {
+    run_job_t runs[PSORT_MAX_THREADS];
+    merge_job_t merges[PSORT_MAX_THREADS];
+    size_t bounds[PSORT_MAX_THREADS + 1];
+    size_t nruns, npairs, parts, total, p, r, k;
+    void * scratch, * src, * dst, * tmp;
+    int njobs;
+
+    if (nthreads <= 0)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > PSORT_MAX_THREADS)
+        nthreads = PSORT_MAX_THREADS;
+    if ((size_t)nthreads > count / PSORT_MIN_RUN)
+        nthreads = (int)(count / PSORT_MIN_RUN);
+
+    //too small to be worth splitting
+    if (nthreads <= 1) {
+        qsort(base, count, element_size, cmp);
+        return VEC_SUCCESS;
+    }
+
+    scratch = vec_mem_alloc(allocator, count * element_size);
+    if (scratch == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //sort one run per thread
+    nruns = nthreads;
+    for (r = 0; r <= nruns; r++)
+        bounds[r] = count * r / nruns;
+    for (r = 0; r < nruns; r++) {
+        runs[r].base = base + bounds[r] * element_size;
+        runs[r].count = bounds[r + 1] - bounds[r];
+        runs[r].element_size = element_size;
+        runs[r].cmp = cmp;
+    }
+    run_all(run_sort, runs, sizeof(run_job_t), nruns);
+
+    //merge neighbouring runs back and forth between the array and scratch,
+    //giving each pair an equal share of the threads
+    src = base;
+    dst = scratch;
+    while (nruns > 1) {
+        npairs = nruns / 2;
+        parts = nthreads / npairs;
+        if (parts == 0)
+            parts = 1;
+        njobs = 0;
+
+        for (p = 0; p < npairs; p++) {
+            total = bounds[2 * p + 2] - bounds[2 * p];
+            for (k = 0; k < parts; k++) {
+                merges[njobs].a = src + bounds[2 * p] * element_size;
+                merges[njobs].na = bounds[2 * p + 1] - bounds[2 * p];
+                merges[njobs].b = src + bounds[2 * p + 1] * element_size;
+                merges[njobs].nb = bounds[2 * p + 2] - bounds[2 * p + 1];
+                merges[njobs].out = dst + bounds[2 * p] * element_size;
+                merges[njobs].begin = total * k / parts;
+                merges[njobs].end = total * (k + 1) / parts;
+                merges[njobs].element_size = element_size;
+                merges[njobs].cmp = cmp;
+                njobs++;
+            }
+        }
+        run_all(merge_range, merges, sizeof(merge_job_t), njobs);
+
+        //an odd run out has nobody to merge with, carry it over as is
+        if (nruns % 2)
+            memcpy(dst + bounds[nruns - 1] * element_size, src + bounds[nruns - 1] * element_size,
+                    (bounds[nruns] - bounds[nruns - 1]) * element_size);
+
+        for (r = 0; r < npairs; r++)
+            bounds[r + 1] = bounds[2 * r + 2];
+        if (nruns % 2)
+            bounds[npairs + 1] = bounds[nruns];
+        nruns = npairs + nruns % 2;
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != base)
+        memcpy(base, src, count * element_size);
+
+    vec_mem_free(allocator, scratch, count * element_size);
+
+    return VEC_SUCCESS;
+}
@@ -0,0 +1,39 @@
+#ifndef PSORT_H
+
+#define PSORT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "../vec_errors.h"
+#include "../alloc/vec_alloc.h"
+
+/**
+ * below this many elements per thread the threads cost more than they save,
+ * so vec_psort uses fewer threads, down to a plain qsort.
+ */
+#define PSORT_MIN_RUN 16384
+
+/**
+ * the most threads vec_psort will start for one call
+ */
+#define PSORT_MAX_THREADS 64
+
+/**
+ * sorts count elements of element_size at base with a parallel merge sort.
+ * The array is cut into one run per thread, the runs are qsorted side by side,
+ * then merged pairwise. Every merge is itself split across the threads, so
+ * the last merge is just as parallel as the first. Threads are started for the
+ * call and joined before it returns.
+ *
+ * nthreads <= 0 uses one thread per online cpu. The merges need a scratch buffer
+ * as large as the array, which comes from allocator (NULL for the system allocator).
+ * Like qsort, the sort is not stable.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int vec_psort(void * base, size_t count, size_t element_size,
+        int (*cmp)(const void *, const void *), int nthreads, const vec_allocator_t * allocator);
+
+#endif
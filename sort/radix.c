@@ -0,0 +1,99 @@
+#include <string.h>
+#include "radix.h"
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+//reads the key at p as an unsigned number that sorts the same way as the key
+static inline uint64_t read_key(const unsigned char * p, size_t key_width, int flags) {
+    uint8_t k8;
+    uint16_t k16;
+    uint32_t k32;
+    uint64_t key;
+
+    switch (key_width) {
+        case 1: memcpy(&k8, p, 1); key = k8; break;
+        case 2: memcpy(&k16, p, 2); key = k16; break;
+        case 4: memcpy(&k32, p, 4); key = k32; break;
+        default: memcpy(&key, p, 8); break;
+    }
+
+    //flipping the sign bit puts negative numbers before positive ones
+    if (flags & VEC_RADIX_SIGNED)
+        key ^= (uint64_t)1 << (key_width * 8 - 1);
+
+    return key;
+}
+
+static inline void copy_element(void * dst, const void * src, size_t element_size) {
+    switch (element_size) {
+        case 4: memcpy(dst, src, 4); break;
+        case 8: memcpy(dst, src, 8); break;
+        case 16: memcpy(dst, src, 16); break;
+        default: memcpy(dst, src, element_size); break;
+    }
+}
+
+int vec_radix_sort(void * base, size_t count, size_t element_size, size_t key_offset,
+        size_t key_width, int flags, const vec_allocator_t * allocator) {
+    size_t counts[sizeof(uint64_t)][RADIX_BUCKETS];
+    unsigned char * src, * dst, * tmp, * scratch;
+    size_t pass, i, sum, n;
+    uint64_t key;
+    int shift;
+
+    if ((key_width != 1 && key_width != 2 && key_width != 4 && key_width != 8)
+            || key_offset + key_width > element_size)
+        return VEC_INVALID_ARGUMENT;
+
+    if (count < 2)
+        return VEC_SUCCESS;
+
+    scratch = vec_mem_alloc(allocator, count * element_size);
+    if (scratch == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //histogram every byte of the key in a single pass over the data
+    memset(counts, 0, sizeof(counts));
+    src = base;
+    for (i = 0; i < count; i++) {
+        key = read_key(src + i * element_size + key_offset, key_width, flags);
+        for (pass = 0; pass < key_width; pass++)
+            counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+
+    dst = scratch;
+    for (pass = 0; pass < key_width; pass++) {
+        shift = pass * RADIX_BITS;
+        key = read_key(src + key_offset, key_width, flags);
+
+        //every key has the same byte here, the pass would not move anything
+        if (counts[pass][(key >> shift) & (RADIX_BUCKETS - 1)] == count)
+            continue;
+
+        //turn the counts into the offset each bucket starts at
+        for (sum = 0, i = 0; i < RADIX_BUCKETS; i++) {
+            n = counts[pass][i];
+            counts[pass][i] = sum;
+            sum += n;
+        }
+
+        for (i = 0; i < count; i++) {
+            key = read_key(src + i * element_size + key_offset, key_width, flags);
+            copy_element(dst + counts[pass][(key >> shift) & (RADIX_BUCKETS - 1)]++ * element_size,
+                    src + i * element_size, element_size);
+        }
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    //an odd number of passes left the result in scratch
+    if (src != base)
+        memcpy(base, src, count * element_size);
+
+    vec_mem_free(allocator, scratch, count * element_size);
+
+    return VEC_SUCCESS;
+}
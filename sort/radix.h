@@ -0,0 +1,28 @@
+#ifndef RADIX_H
+
+#define RADIX_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "../vec_errors.h"
+#include "../vec_types.h"
+#include "../alloc/vec_alloc.h"
+
+/**
+ * sorts count elements of element_size at base by the integer key of key_width
+ * bytes (1, 2, 4 or 8) stored key_offset bytes into each element, in the machine's
+ * byte order. LSD radix sort one byte at a time: all the byte histograms are
+ * counted in one pass over the data, and a byte that is the same in every key
+ * skips its pass entirely. Elements move back and forth between the array and a
+ * scratch buffer as large as the array, which comes from allocator (NULL for the
+ * system allocator). The sort is stable.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT if key_width is not 1, 2, 4 or 8, or the key does not fit in the element
+ */
+int vec_radix_sort(void * base, size_t count, size_t element_size, size_t key_offset,
+        size_t key_width, int flags, const vec_allocator_t * allocator);
+
+#endif
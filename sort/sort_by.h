@@ -0,0 +1,126 @@
+#ifndef SORT_BY_H
+
+#define SORT_BY_H
+
+#include <stddef.h>
+
+/**
+ * the introsort behind VEC_SORT_BY and SYNC_VEC_SORT_BY, kept here so both headers
+ * share one copy. Sorts n elements of type T at base, in place and not stably.
+ * a and b are the names of two T * variables the macro declares, and less_expr is
+ * a boolean expression that is true when *a belongs before *b, for example
+ * a->key < b->key.  Everything is expanded inline for T, so there is no function
+ * pointer call per comparison and elements are moved as whole T's.
+ *
+ * Ranges are quicksorted with a median of three pivot, the larger side is pushed
+ * on a small stack and the smaller one handled next, so the stack never needs more
+ * than log2(n) entries.  A range that recurses deeper than 2 * log2(n) is heapsorted
+ * instead, so bad inputs stay O(n log n), and ranges of VEC_SORT_SMALL elements or
+ * fewer are finished with insertion sort.
+ */
+#define VEC_SORT_SMALL 16
+
+//evaluates less_expr for the elements at x and y
+#define _VEC_SORT_LESS(x, y, a, b, less_expr) ((a) = (x), (b) = (y), (less_expr))
+
+#define _VEC_SORT_SWAP(T, x, y) do {\
+        T _swap_tmp = *(x);\
+        *(x) = *(y);\
+        *(y) = _swap_tmp;\
+} while (0)
+
+//moves the element at root of the heap at heap down until it is larger than its children
+#define _VEC_SORT_SIFT(T, heap, root, len, a, b, less_expr) do {\
+        size_t _r = (root), _c;\
+        while ((_c = 2 * _r + 1) < (len)) {\
+            if (_c + 1 < (len) && _VEC_SORT_LESS(&(heap)[_c], &(heap)[_c + 1], a, b, less_expr))\
+                _c++;\
+            if (!_VEC_SORT_LESS(&(heap)[_r], &(heap)[_c], a, b, less_expr))\
+                break;\
+            _VEC_SORT_SWAP(T, &(heap)[_r], &(heap)[_c]);\
+            _r = _c;\
+        }\
+} while (0)
+
+#define VEC_SORT_ARRAY_BY(T, base, n, a, b, less_expr) do {\
+        /* a typedef so pointer types like char * declare correctly */\
+        typedef T _vec_sort_t;\
+        _vec_sort_t * _base = (base);\
+        _vec_sort_t * a, * b;\
+        _vec_sort_t _pivot, _tmp;\
+        size_t _n = (n), _lo, _hi, _mid, _i, _j, _k;\
+        size_t _stack_lo[64], _stack_hi[64];\
+        int _stack_depth[64], _top = 0, _depth;\
+        (void)a; (void)b;\
+        if (_n > 1) {\
+            for (_depth = 0, _k = _n; _k > 1; _k >>= 1)\
+                _depth += 2;\
+            _stack_lo[0] = 0;\
+            _stack_hi[0] = _n;\
+            _stack_depth[0] = _depth;\
+            _top = 1;\
+        }\
+        while (_top > 0) {\
+            _top--;\
+            _lo = _stack_lo[_top];\
+            _hi = _stack_hi[_top];\
+            _depth = _stack_depth[_top];\
+            while (_hi - _lo > VEC_SORT_SMALL) {\
+                /* too deep, quicksort is hitting a bad case so heapsort the range */\
+                if (_depth-- == 0) {\
+                    _k = _hi - _lo;\
+                    for (_i = _k / 2; _i-- > 0;)\
+                        _VEC_SORT_SIFT(_vec_sort_t, _base + _lo, _i, _k, a, b, less_expr);\
+                    for (_i = _k; _i-- > 1;) {\
+                        _VEC_SORT_SWAP(_vec_sort_t, &_base[_lo], &_base[_lo + _i]);\
+                        _VEC_SORT_SIFT(_vec_sort_t, _base + _lo, 0, _i, a, b, less_expr);\
+                    }\
+                    _hi = _lo;\
+                    break;\
+                }\
+                /* median of three, which also leaves a sentinel at both ends */\
+                _mid = _lo + (_hi - _lo) / 2;\
+                if (_VEC_SORT_LESS(&_base[_mid], &_base[_lo], a, b, less_expr))\
+                    _VEC_SORT_SWAP(_vec_sort_t, &_base[_mid], &_base[_lo]);\
+                if (_VEC_SORT_LESS(&_base[_hi - 1], &_base[_mid], a, b, less_expr)) {\
+                    _VEC_SORT_SWAP(_vec_sort_t, &_base[_hi - 1], &_base[_mid]);\
+                    if (_VEC_SORT_LESS(&_base[_mid], &_base[_lo], a, b, less_expr))\
+                        _VEC_SORT_SWAP(_vec_sort_t, &_base[_mid], &_base[_lo]);\
+                }\
+                _pivot = _base[_mid];\
+                _i = _lo;\
+                _j = _hi - 1;\
+                while (1) {\
+                    while (_VEC_SORT_LESS(&_base[_i], &_pivot, a, b, less_expr))\
+                        _i++;\
+                    while (_VEC_SORT_LESS(&_pivot, &_base[_j], a, b, less_expr))\
+                        _j--;\
+                    if (_i >= _j)\
+                        break;\
+                    _VEC_SORT_SWAP(_vec_sort_t, &_base[_i], &_base[_j]);\
+                    _i++;\
+                    _j--;\
+                }\
+                /* [_lo, _j] and [_j + 1, _hi), keep going on the smaller one */\
+                if (_j + 1 - _lo < _hi - _j - 1) {\
+                    _stack_lo[_top] = _j + 1;\
+                    _stack_hi[_top] = _hi;\
+                    _hi = _j + 1;\
+                } else {\
+                    _stack_lo[_top] = _lo;\
+                    _stack_hi[_top] = _j + 1;\
+                    _lo = _j + 1;\
+                }\
+                _stack_depth[_top] = _depth;\
+                _top++;\
+            }\
+            for (_i = _lo + 1; _i < _hi; _i++) {\
+                _tmp = _base[_i];\
+                for (_j = _i; _j > _lo && _VEC_SORT_LESS(&_tmp, &_base[_j - 1], a, b, less_expr); _j--)\
+                    _base[_j] = _base[_j - 1];\
+                _base[_j] = _tmp;\
+            }\
+        }\
+} while (0)
+
+#endif
@@ -0,0 +1,143 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sring.h"
+
+#define MIN_SIZE 64
+
+static int init_lock(sync_ring_t * sring) {
+    pthread_rwlockattr_t attr;
+    int res;
+
+    pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__) && defined(__USE_GNU)
+    //producers and consumers both write, do not let readers starve them
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    res = pthread_rwlock_init(&(sring->lock), &attr);
+    pthread_rwlockattr_destroy(&attr);
+
+    return res;
+}
+
+int sync_ring_init(sync_ring_t * sring, size_t element_size) {
+    return sync_ring_init_with_capacity(sring, element_size, MIN_SIZE);
+}
+
+int sync_ring_init_with_capacity(sync_ring_t * sring, size_t element_size, int capacity) {
+    int res;
+
+    if ((res = ring_init_with_capacity(&sring->ring, element_size, capacity)))
+        return res;
+
+    if (init_lock(sring)) {
+        ring_destroy(&sring->ring);
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
+
+    return VEC_SUCCESS;
+}
+
+int sync_ring_init_with_allocator(sync_ring_t * sring, size_t element_size, int capacity, const vec_allocator_t * allocator) {
+    //check already initialized
+    if (sring->ring.array != NULL && sring->ring.allocated_slots > 0)
+        return VEC_ALREADY_INITIALIZED;
+
+    sring->ring.allocator = allocator;
+    return sync_ring_init_with_capacity(sring, element_size, capacity);
+}
+
+int sync_ring_push_back(sync_ring_t * sring, void * element_ptr) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_push_back(&sring->ring, element_ptr);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_push_front(sync_ring_t * sring, void * element_ptr) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_push_front(&sring->ring, element_ptr);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_pop_back(sync_ring_t * sring, void * element_buffer) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_pop_back(&sring->ring, element_buffer);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_pop_front(sync_ring_t * sring, void * element_buffer) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_pop_front(&sring->ring, element_buffer);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_get(sync_ring_t * sring, int idx, void * element_buffer) {
+    int res;
+    SYNC_RING_READ_LOCK(sring);
+    res = ring_get(&sring->ring, idx, element_buffer);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_replace(sync_ring_t * sring, void * element_ptr, int idx) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_replace(&sring->ring, element_ptr, idx);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_len(sync_ring_t * sring) {
+    int res;
+    SYNC_RING_READ_LOCK(sring);
+    res = ring_len(&sring->ring);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_reserve(sync_ring_t * sring, int capacity) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_reserve(&sring->ring, capacity);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_shrink_to_fit(sync_ring_t * sring) {
+    int res;
+    SYNC_RING_WRITE_LOCK(sring);
+    res = ring_shrink_to_fit(&sring->ring);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_to_array(sync_ring_t * sring, void ** resultptr) {
+    int res;
+    SYNC_RING_READ_LOCK(sring);
+    res = ring_to_array(&sring->ring, resultptr);
+    SYNC_RING_UNLOCK(sring);
+    return res;
+}
+
+int sync_ring_destroy(sync_ring_t * sring) {
+    if (sring->ring.array == NULL)
+        return VEC_ALREADY_DESTROYED;
+
+    //wait for anyone still using the ring to finish
+    SYNC_RING_WRITE_LOCK(sring);
+    ring_destroy(&sring->ring);
+    SYNC_RING_UNLOCK(sring);
+
+    pthread_rwlock_destroy(&(sring->lock));
+    memset(sring, 0, sizeof(sync_ring_t));
+
+    return VEC_SUCCESS;
+}
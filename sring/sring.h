@@ -0,0 +1,97 @@
+#ifndef SRING_H
+
+#define SRING_H
+
+#include <pthread.h>
+#include "../ring/ring.h"
+
+/**
+ * thread safe version of ring_t, for work queues shared between threads.
+ * Every sync_ring_t is guarded by a reader-writer lock like sync_vec_t: sync_ring_get,
+ * sync_ring_len and sync_ring_to_array take it shared, everything else exclusive.
+ * Pushing and popping are O(1) under the lock, so producers and consumers hold it only
+ * for one copy of an element. Implemented in sring.c on top of ring.c, link with -lpthread.
+ */
+typedef struct {
+    ring_t ring;
+    pthread_rwlock_t lock;
+} sync_ring_t;
+
+#define SYNC_RING_READ_LOCK(sring) pthread_rwlock_rdlock(&(sring)->lock)
+#define SYNC_RING_WRITE_LOCK(sring) pthread_rwlock_wrlock(&(sring)->lock)
+#define SYNC_RING_UNLOCK(sring) pthread_rwlock_unlock(&(sring)->lock)
+
+/**
+ * given a pointer to a zeroed sync_ring_t struct, and the size of
+ * the elements that will be stored in it, initializes the ring and its lock.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int sync_ring_init(sync_ring_t * sring, size_t element_size);
+
+/**
+ * same as sync_ring_init, but allocates room for at least capacity elements up front.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int sync_ring_init_with_capacity(sync_ring_t * sring, size_t element_size, int capacity);
+
+/**
+ * same as sync_ring_init_with_capacity, but all of the ring's memory comes from allocator.
+ * The allocator is called with the lock held, and must be thread safe if it is shared.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int sync_ring_init_with_allocator(sync_ring_t * sring, size_t element_size, int capacity, const vec_allocator_t * allocator);
+
+/**
+ * the ring_ functions of the same name, each run under the lock.
+ * They behave and fail exactly like them, see ring.h.
+ */
+int sync_ring_push_back(sync_ring_t * sring, void * element_ptr);
+int sync_ring_push_front(sync_ring_t * sring, void * element_ptr);
+int sync_ring_pop_back(sync_ring_t * sring, void * element_buffer);
+int sync_ring_pop_front(sync_ring_t * sring, void * element_buffer);
+int sync_ring_get(sync_ring_t * sring, int idx, void * element_buffer);
+int sync_ring_replace(sync_ring_t * sring, void * element_ptr, int idx);
+int sync_ring_len(sync_ring_t * sring);
+int sync_ring_reserve(sync_ring_t * sring, int capacity);
+int sync_ring_shrink_to_fit(sync_ring_t * sring);
+int sync_ring_to_array(sync_ring_t * sring, void ** resultptr);
+
+/**
+ * frees all memory given to this ring, after waiting for anyone still using it.
+ * Nothing may use the ring once this has been called.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_ALREADY_DESTROYED
+ */
+int sync_ring_destroy(sync_ring_t * sring);
+
+/**
+ * same as RING_ITER, holding the write lock for the whole loop.
+ * element_ptr is a x * variable that is pointed at each element in turn.
+ * break will work to end early. Do not push or pop from inside the expression.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define SYNC_RING_ITER(sring, element_ptr, expression) ({\
+        SYNC_RING_WRITE_LOCK(sring);\
+        int _ret = RING_ITER(&(sring)->ring, element_ptr, expression);\
+        SYNC_RING_UNLOCK(sring);\
+        _ret;\
+})
+#endif
@@ -1,234 +1,727 @@
+#define _GNU_SOURCE
 #include <stdlib.h>
 #include <string.h>
-#include <semaphore.h>
+#include <pthread.h>
 #include "svec.h"
 
 #define MIN_SIZE 64
+#define DEFAULT_GROWTH_FACTOR 2.0f
+#define DEFAULT_SHRINK_DIVISOR 4
 
-int grow(sync_vec_t * vector) {
-    void * tmp = realloc(vector->array, vector->allocated_slots * 2 * vector->element_size);
+static float growth_factor(sync_vec_t * vector) {
+    if (vector->policy.growth_factor > 1.0f)
+        return vector->policy.growth_factor;
+    return DEFAULT_GROWTH_FACTOR;
+}
+
+static uint32_t shrink_divisor(sync_vec_t * vector) {
+    if (vector->policy.shrink_divisor > 0)
+        return vector->policy.shrink_divisor;
+    return DEFAULT_SHRINK_DIVISOR;
+}
+
+static int resize(sync_vec_t * vector, uint32_t new_slots) {
+    void * tmp;
+
+    //the size of the array must not wrap around, reserve takes any capacity
+    if (vector->element_size != 0 && (size_t)new_slots > SIZE_MAX / vector->element_size)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    tmp = vec_mem_realloc(vector->allocator, vector->array,
+            (size_t)vector->allocated_slots * vector->element_size,
+            (size_t)new_slots * vector->element_size);
     if (tmp == NULL) 
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
     vector->array = tmp;
-    vector->allocated_slots *= 2;
+    vector->allocated_slots = new_slots;
 
     return VEC_SUCCESS;
 }
 
+int grow(sync_vec_t * vector, uint32_t needed) {
+    uint32_t new_slots = vector->allocated_slots;
+    float factor = growth_factor(vector);
+    double next;
+
+    //already big enough, nothing to do
+    if (needed <= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    //keep growing by the policy's factor until it fits so a bulk insert only reallocs once
+    while (new_slots < needed) {
+        next = (double)new_slots * factor;
+        if (new_slots == 0)
+            new_slots = MIN_SIZE;
+        else if (next > UINT32_MAX)
+            new_slots = needed;
+        else if ((uint32_t)next <= new_slots)
+            new_slots++;
+        else
+            new_slots = (uint32_t)next;
+    }
+
+    return resize(vector, new_slots);
+}
+
 int shrink(sync_vec_t * vector) {
-    void * tmp = realloc(vector->array, vector->allocated_slots * vector->element_size / 2);
-    if (tmp == NULL) 
-        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    uint32_t new_slots;
+    double target;
 
-    vector->array = tmp;
-    vector->allocated_slots /= 2;
+    //never shrink below the minimum, or at all if the policy says so
+    if ((vector->policy.flags & VEC_NEVER_SHRINK) || vector->allocated_slots <= MIN_SIZE)
+        return VEC_SUCCESS;
 
-    return VEC_SUCCESS;
+    //only shrink once usage drops below 1/shrink_divisor of the allocation
+    if (vector->used_slots >= vector->allocated_slots / shrink_divisor(vector))
+        return VEC_SUCCESS;
+
+    //leave one growth step of headroom so a vector hovering around the
+    //threshold does not realloc back and forth
+    target = (double)vector->used_slots * growth_factor(vector);
+    new_slots = target < MIN_SIZE ? MIN_SIZE : (uint32_t)target;
+    if (new_slots >= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    return resize(vector, new_slots);
+}
+
+static int init_lock(sync_vec_t * vector) {
+    pthread_rwlockattr_t attr;
+    int res;
+
+    pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__) && defined(__USE_GNU)
+    //glibc lets readers starve writers by default, we have far more readers
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    res = pthread_rwlock_init(&(vector->lock), &attr);
+    pthread_rwlockattr_destroy(&attr);
+
+    return res;
 }
 
 int sync_init (sync_vec_t * vector, size_t element_size) {
+    return sync_init_with_capacity(vector, element_size, MIN_SIZE);
+}
+
+int sync_init_with_capacity(sync_vec_t * vector, size_t element_size, int capacity) {
     //check already initialized
     if (vector->array != NULL && vector->allocated_slots > 0) 
         return VEC_ALREADY_INITIALIZED;
 
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    //always hold at least one slot so the vector reads as initialized
+    if (capacity == 0)
+        capacity = 1;
+
+    //the size of the array must not wrap around
+    if (element_size != 0 && (size_t)capacity > SIZE_MAX / element_size)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
     vector->element_size = element_size;
     vector->used_slots = 0;
 
-    vector->allocated_slots = MIN_SIZE;
-    vector->array = calloc(MIN_SIZE, element_size);
+    vector->allocated_slots = capacity;
+    vector->array = vec_mem_alloc(vector->allocator, (size_t)capacity * element_size);
 
     //check memory allocation
     if (vector->array == NULL) 
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
-    sem_init(&(vector->lock), 0, 1);
+    if (init_lock(vector)) {
+        vec_mem_free(vector->allocator, vector->array, (size_t)capacity * element_size);
+        vector->array = NULL;
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
 
     //everything is good
     return VEC_SUCCESS;
 }
-int sync_insert(sync_vec_t * vector, void * element_ptr, int idx) {
-    int i;
-    sem_wait(&(vector->lock));
-    //check that have enough space, grow if necesary
-    if (vector->used_slots == vector->allocated_slots - 1) {
-        if (grow(vector)) {
-            sem_post(&(vector->lock));
-            return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
-        }
-    }
+int sync_init_with_allocator(sync_vec_t * vector, size_t element_size, int capacity, const vec_allocator_t * allocator) {
+    //check already initialized
+    if (vector->array != NULL && vector->allocated_slots > 0) 
+        return VEC_ALREADY_INITIALIZED;
+
+    vector->allocator = allocator;
+    return sync_init_with_capacity(vector, element_size, capacity);
+}
+
+int sync_begin(sync_vec_t * vector) {
+    SYNC_VEC_WRITE_LOCK(vector);
+    return VEC_SUCCESS;
+}
+
+int sync_commit(sync_vec_t * vector) {
+    SYNC_VEC_UNLOCK(vector);
+    return VEC_SUCCESS;
+}
+
+int sync_begin_read(sync_vec_t * vector) {
+    SYNC_VEC_READ_LOCK(vector);
+    return VEC_SUCCESS;
+}
+
+int sync_end_read(sync_vec_t * vector) {
+    SYNC_VEC_UNLOCK(vector);
+    return VEC_SUCCESS;
+}
+
+int sync_reserve_locked(sync_vec_t * vector, int capacity) {
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    //grow to exactly the requested size, the caller knows best
+    if ((uint32_t)capacity <= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    return resize(vector, capacity);
+}
+
+int sync_reserve(sync_vec_t * vector, int capacity) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_reserve_locked(vector, capacity);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_shrink_to_fit_locked(sync_vec_t * vector) {
+    uint32_t new_slots = vector->used_slots > 0 ? vector->used_slots : 1;
+
+    if (new_slots == vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    return resize(vector, new_slots);
+}
+
+int sync_shrink_to_fit(sync_vec_t * vector) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_shrink_to_fit_locked(vector);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_set_policy_locked(sync_vec_t * vector, vec_policy_t * policy) {
+    vec_policy_t defaults = VEC_DEFAULT_POLICY;
+    float factor;
+
+    if (policy == NULL)
+        policy = &defaults;
+
+    //0 means use the default for each field
+    if (policy->growth_factor != 0.0f && !(policy->growth_factor > 1.0f))
+        return VEC_INVALID_ARGUMENT;
 
+    //a vector that shrinks to within one growth step of the threshold would thrash
+    factor = policy->growth_factor > 1.0f ? policy->growth_factor : DEFAULT_GROWTH_FACTOR;
+    if (policy->shrink_divisor != 0 && !(policy->shrink_divisor > factor))
+        return VEC_INVALID_ARGUMENT;
+
+    vector->policy = *policy;
+
+    return VEC_SUCCESS;
+}
+
+int sync_set_policy(sync_vec_t * vector, vec_policy_t * policy) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_set_policy_locked(vector, policy);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_insert_range_locked(sync_vec_t * vector, void * elements, int count, int idx) {
     //check bounds
-    if (!(idx >=0 && (size_t)idx <= vector->used_slots)) {
-        sem_post(&(vector->lock));
+    if (!(idx >=0 && (size_t)idx <= vector->used_slots) || count < 0) 
         return VEC_INDEX_OUT_OF_BOUNDS;
-    }
-    
-    //move everything over one
-    for (i = vector->used_slots; i > idx; i--) {
-        memcpy(vector->array + (i) * vector->element_size,
-                vector->array + (i - 1) * vector->element_size,
-                vector->element_size);
-    }
+
+    if (count == 0)
+        return VEC_SUCCESS;
+
+    if (elements == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check that have enough space, grow once if necesary
+    if ((uint32_t)count > UINT32_MAX - vector->used_slots)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    if (grow(vector, vector->used_slots + count)) 
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //move the tail over by count in one go
+    memmove(vector->array + (idx + count) * vector->element_size,
+            vector->array + idx * vector->element_size,
+            (vector->used_slots - idx) * vector->element_size);
     //insert
-    memcpy(vector->array + idx * vector->element_size, element_ptr, vector->element_size);
+    memcpy(vector->array + idx * vector->element_size, elements, count * vector->element_size);
 
-    vector->used_slots++;
+    vector->used_slots += count;
 
-    sem_post(&(vector->lock));
     return VEC_SUCCESS;
+}
 
+int sync_insert_range(sync_vec_t * vector, void * elements, int count, int idx) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_insert_range_locked(vector, elements, count, idx);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
 }
 
-int sync_replace(sync_vec_t * vector, void * element_ptr, int idx) {
-    sem_wait(&(vector->lock));
+int sync_insert_locked(sync_vec_t * vector, void * element_ptr, int idx) {
+    return sync_insert_range_locked(vector, element_ptr, 1, idx);
+}
+
+int sync_insert(sync_vec_t * vector, void * element_ptr, int idx) {
+    return sync_insert_range(vector, element_ptr, 1, idx);
+}
+
+int sync_replace_locked(sync_vec_t * vector, void * element_ptr, int idx) {
     //check bounds
-    if (!(idx >=0 && (size_t)idx < vector->used_slots)) {
-        sem_post(&(vector->lock));
+    if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
         return VEC_INDEX_OUT_OF_BOUNDS;
-    }
 
     //overwrite the other thing
     memcpy(vector->array + idx * vector->element_size, element_ptr, vector->element_size);
-    sem_post(&(vector->lock));
     return VEC_SUCCESS;
+}
+
+int sync_replace(sync_vec_t * vector, void * element_ptr, int idx) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_replace_locked(vector, element_ptr, idx);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
 
+int sync_append_n_locked(sync_vec_t * vector, void * elements, int count) {
+    return sync_insert_range_locked(vector, elements, count, vector->used_slots);
+}
+
+int sync_append_n(sync_vec_t * vector, void * elements, int count) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    //read the length under the lock so concurrent appends cannot race on the index
+    res = sync_append_n_locked(vector, elements, count);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_append_locked(sync_vec_t * vector, void * element_ptr) {
+    return sync_append_n_locked(vector, element_ptr, 1);
 }
 
 int sync_append(sync_vec_t * vector, void * element_ptr) {
-    return sync_insert(vector, element_ptr, vector->used_slots);
+    return sync_append_n(vector, element_ptr, 1);
 }
+
 int sync_veclen(sync_vec_t * vector) {
     return vector->used_slots;
 }
-int sync_remove_index(sync_vec_t * vector, int idx) {
+
+int sync_remove_range_locked(sync_vec_t * vector, int idx, int count) {
+    //check bounds
+    if (!(idx >=0 && count >= 0 && (size_t)idx + count <= vector->used_slots)) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    if (count == 0)
+        return VEC_SUCCESS;
+    
+    //move the tail over by count in one go
+    memmove(vector->array + idx * vector->element_size,
+            vector->array + (idx + count) * vector->element_size,
+            (vector->used_slots - idx - count) * vector->element_size);
+
+    //zero out what was last
+    vector->used_slots -= count;
+    memset(vector->array + vector->used_slots * vector->element_size, 0, count * vector->element_size);
+
+    //shrink if usage dropped below what the policy allows
+    if (shrink(vector))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    return VEC_SUCCESS;
+}
+
+int sync_remove_range(sync_vec_t * vector, int idx, int count) {
     int res;
-    sem_wait(&(vector->lock));
-    res = remove_index(vector, idx);
-    sem_post(&(vector->lock));
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_remove_range_locked(vector, idx, count);
+    SYNC_VEC_UNLOCK(vector);
     return res;
 }
+
+int sync_truncate_locked(sync_vec_t * vector, int len) {
+    //check bounds
+    if (!(len >= 0 && (size_t)len <= vector->used_slots)) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    return sync_remove_range_locked(vector, len, vector->used_slots - len);
+}
+
+int sync_truncate(sync_vec_t * vector, int len) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_truncate_locked(vector, len);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_remove_index_locked(sync_vec_t * vector, int idx) {
+    return sync_remove_range_locked(vector, idx, 1);
+}
+
+int sync_remove_index(sync_vec_t * vector, int idx) {
+    return sync_remove_range(vector, idx, 1);
+}
+
 int remove_index(sync_vec_t * vector, int idx) {
+    return sync_remove_index_locked(vector, idx);
+}
+
+int sync_remove_element_locked(sync_vec_t * vector, void * element_ptr) {
     int i;
+    if (element_ptr == NULL) 
+        return VEC_NULL_BUFFER;
+
+    for (i = 0; (size_t)i < vector->used_slots; i++) {
+        if (memcmp(vector->array + i * vector->element_size, element_ptr, vector->element_size) == 0) {
+            return sync_remove_index_locked(vector, i);
+        }
+    }
+    return VEC_NOT_FOUND;
+}
+
+int sync_remove_element(sync_vec_t * vector, void * element_ptr) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_remove_element_locked(vector, element_ptr);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_swap_remove_locked(sync_vec_t * vector, int idx) {
+    uint32_t last;
+
     //check bounds
     if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
         return VEC_INDEX_OUT_OF_BOUNDS;
-    
-    //move everything over one
-    for (i = idx; (size_t)i < vector-> used_slots; i++) {
-        memcpy(vector->array + (i) * vector->element_size,
-                vector->array + (i + 1) * vector->element_size,
-                vector->element_size);
-    }
+
+    //the last element fills the hole
+    last = vector->used_slots - 1;
+    if ((uint32_t)idx != last)
+        memcpy(vector->array + idx * vector->element_size, vector->array + last * vector->element_size, vector->element_size);
 
     //zero out what was last
-    memset(vector->array + (--vector->used_slots) * vector->element_size, 0, vector->element_size);
+    vector->used_slots = last;
+    memset(vector->array + last * vector->element_size, 0, vector->element_size);
 
-    //shrink if now use 1/4 space as allocated
-    if (vector->used_slots < vector->allocated_slots/4 && vector->allocated_slots > MIN_SIZE) {
-        if (!shrink(vector))
-            return VEC_COULD_NOT_ALLOCATE_MEMORY;
-    }
+    //shrink if usage dropped below what the policy allows
+    if (shrink(vector))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
     return VEC_SUCCESS;
 }
-int sync_remove_element(sync_vec_t * vector, void * element_ptr) {
+
+int sync_swap_remove(sync_vec_t * vector, int idx) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_swap_remove_locked(vector, idx);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_swap_remove_element_locked(sync_vec_t * vector, void * element_ptr) {
     int i;
-    sem_wait(&(vector->lock));
-    if (element_ptr == NULL) {
-        sem_post(&(vector->lock));
+    if (element_ptr == NULL) 
         return VEC_NULL_BUFFER;
-    }
 
     for (i = 0; (size_t)i < vector->used_slots; i++) {
         if (memcmp(vector->array + i * vector->element_size, element_ptr, vector->element_size) == 0) {
-            sem_post(&(vector->lock));
-            return remove_index(vector, i);
+            return sync_swap_remove_locked(vector, i);
         }
     }
-    sem_post(&(vector->lock));
     return VEC_NOT_FOUND;
 }
-int sync_get(sync_vec_t * vector, int idx, void * element_buffer) {
-    sem_wait(&(vector->lock));
-    if (element_buffer == NULL) {
-        sem_post(&(vector->lock));
+
+int sync_swap_remove_element(sync_vec_t * vector, void * element_ptr) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_swap_remove_element_locked(vector, element_ptr);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_get_locked(sync_vec_t * vector, int idx, void * element_buffer) {
+    if (element_buffer == NULL) 
         return VEC_NULL_BUFFER;
-    }
 
     //check bounds
-    if (!(idx >=0 && (size_t)idx < vector->used_slots)) {
-        sem_post(&(vector->lock));
+    if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
         return VEC_INDEX_OUT_OF_BOUNDS;
-    }
 
     memcpy(element_buffer, vector->array + idx * vector->element_size, vector->element_size);
-    sem_post(&(vector->lock));
 
     return VEC_SUCCESS;
 }
+
+int sync_get(sync_vec_t * vector, int idx, void * element_buffer) {
+    int res;
+    SYNC_VEC_READ_LOCK(vector);
+    res = sync_get_locked(vector, idx, element_buffer);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
 int sync_destroy(sync_vec_t * vector) {
-    int sem_val;
     if (vector->array == NULL)
         return VEC_ALREADY_DESTROYED;
 
-    free(vector->array);
-    memset(vector, 0,sizeof(sync_vec_t));
+    //wait for anyone still using the vector to finish
+    SYNC_VEC_WRITE_LOCK(vector);
+    vec_mem_free(vector->allocator, vector->array, (size_t)vector->allocated_slots * vector->element_size);
+    vector->array = NULL;
+    SYNC_VEC_UNLOCK(vector);
 
+    pthread_rwlock_destroy(&(vector->lock));
+    memset(vector, 0,sizeof(sync_vec_t));
 
-    do {
-        sem_getvalue(&(vector->lock), &sem_val);
-    } while (sem_val > 0);
-    sem_destroy(&(vector->lock));
+    return VEC_SUCCESS;
+}
 
+int sync_sort_locked(sync_vec_t * vector, cmpfn cmp) {
+    qsort(vector->array,vector->used_slots, vector->element_size,cmp);
     return VEC_SUCCESS;
 }
+
 int sync_sort(sync_vec_t * vector, cmpfn cmp) {
-    sem_wait(&(vector->lock));
-    qsort(vector->array,vector->used_slots, vector->element_size,cmp);
-    sem_post(&(vector->lock));
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_sort_locked(vector, cmp);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+//first index whose element is not less than key, or with upper set, not less or equal
+static uint32_t bound(sync_vec_t * vector, void * key, cmpfn cmp, int upper) {
+    uint32_t lo = 0, hi = vector->used_slots, mid;
+    int c;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        c = cmp(key, vector->array + (size_t)mid * vector->element_size);
+        if (c > 0 || (upper && c == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+int sync_lower_bound_locked(sync_vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    *idx = bound(vector, key, cmp, 0);
     return VEC_SUCCESS;
 }
 
-int sync_copy(sync_vec_t * srcvec, sync_vec_t * dstvec) {
-    sem_wait(&(srcvec->lock));
+int sync_upper_bound_locked(sync_vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    *idx = bound(vector, key, cmp, 1);
+    return VEC_SUCCESS;
+}
+
+int sync_bsearch_locked(sync_vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    uint32_t i;
+
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    //the first equal element, or where key would go
+    i = bound(vector, key, cmp, 0);
+    *idx = i;
+
+    if (i < vector->used_slots && cmp(key, vector->array + (size_t)i * vector->element_size) == 0)
+        return VEC_SUCCESS;
+    return VEC_NOT_FOUND;
+}
+
+int sync_insert_sorted_locked(sync_vec_t * vector, void * element_ptr, cmpfn cmp) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //after any equal elements, so equal elements stay in insertion order
+    return sync_insert_locked(vector, element_ptr, bound(vector, element_ptr, cmp, 1));
+}
+
+int sync_remove_sorted_locked(sync_vec_t * vector, void * element_ptr, cmpfn cmp) {
+    int idx, res;
+
+    if ((res = sync_bsearch_locked(vector, element_ptr, cmp, &idx)))
+        return res;
+
+    return sync_remove_index_locked(vector, idx);
+}
+
+int sync_merge_sorted_locked(sync_vec_t * vector, void * elements, int count, cmpfn cmp) {
+    size_t element_size = vector->element_size;
+    size_t bytes = (size_t)count * element_size;
+    void * batch;
+    int64_t i, j, k;
+
+    if (count < 0)
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    if (count == 0)
+        return VEC_SUCCESS;
+
+    if (elements == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check that have enough space, grow once if necesary
+    if ((uint32_t)count > UINT32_MAX - vector->used_slots)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    if (grow(vector, vector->used_slots + count)) 
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //sort a copy of the batch, the caller's array is left alone. The copy is scratch
+    //space, so it comes from the system like the sorts' buffers, not the vector's allocator
+    batch = vec_mem_alloc(NULL, bytes);
+    if (batch == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    memcpy(batch, elements, bytes);
+    qsort(batch, count, element_size, cmp);
+
+    //merge from the back into the free slots at the end, so nothing is moved twice.
+    //on ties the vector's elements stay in front of the batch's
+    i = (int64_t)vector->used_slots - 1;
+    j = count - 1;
+    k = i + count;
+    while (j >= 0) {
+        if (i >= 0 && cmp(vector->array + i * element_size, batch + j * element_size) > 0) {
+            memcpy(vector->array + k * element_size, vector->array + i * element_size, element_size);
+            i--;
+        } else {
+            memcpy(vector->array + k * element_size, batch + j * element_size, element_size);
+            j--;
+        }
+        k--;
+    }
+
+    vector->used_slots += count;
+    vec_mem_free(NULL, batch, bytes);
+
+    return VEC_SUCCESS;
+}
+
+int sync_lower_bound(sync_vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    int res;
+    SYNC_VEC_READ_LOCK(vector);
+    res = sync_lower_bound_locked(vector, key, cmp, idx);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_upper_bound(sync_vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    int res;
+    SYNC_VEC_READ_LOCK(vector);
+    res = sync_upper_bound_locked(vector, key, cmp, idx);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_bsearch(sync_vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    int res;
+    SYNC_VEC_READ_LOCK(vector);
+    res = sync_bsearch_locked(vector, key, cmp, idx);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_insert_sorted(sync_vec_t * vector, void * element_ptr, cmpfn cmp) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_insert_sorted_locked(vector, element_ptr, cmp);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_remove_sorted(sync_vec_t * vector, void * element_ptr, cmpfn cmp) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_remove_sorted_locked(vector, element_ptr, cmp);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_merge_sorted(sync_vec_t * vector, void * elements, int count, cmpfn cmp) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_merge_sorted_locked(vector, elements, count, cmp);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_copy_locked(sync_vec_t * srcvec, sync_vec_t * dstvec) {
     //check already initialized
-    if (dstvec->array != NULL && dstvec->allocated_slots > 0) {
-        sem_post(&(srcvec->lock));
+    if (dstvec->array != NULL && dstvec->allocated_slots > 0) 
         return VEC_ALREADY_INITIALIZED;
-    }
 
     dstvec->element_size = srcvec->element_size;
+    dstvec->policy = srcvec->policy;
     dstvec->used_slots = srcvec->used_slots;
     dstvec->allocated_slots = srcvec->allocated_slots;
-    dstvec->array = calloc(srcvec->allocated_slots, srcvec->element_size);
+    dstvec->array = vec_mem_alloc(dstvec->allocator, (size_t)srcvec->allocated_slots * srcvec->element_size);
 
     //check memory allocation
-    if (dstvec->array == NULL) {
-        sem_post(&(srcvec->lock));
+    if (dstvec->array == NULL) 
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //the copy needs its own lock
+    if (init_lock(dstvec)) {
+        vec_mem_free(dstvec->allocator, dstvec->array, (size_t)dstvec->allocated_slots * dstvec->element_size);
+        dstvec->array = NULL;
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
     }
     
     memcpy(dstvec->array, srcvec->array, srcvec->allocated_slots * srcvec->element_size);
 
     //everything is good
-    sem_post(&(srcvec->lock));
     return VEC_SUCCESS;
 }
 
-int sync_to_array(sync_vec_t * vec, void ** resultptr) {
-    sem_wait(&(vec->lock));
+int sync_copy(sync_vec_t * srcvec, sync_vec_t * dstvec) {
+    int res;
+    SYNC_VEC_READ_LOCK(srcvec);
+    res = sync_copy_locked(srcvec, dstvec);
+    SYNC_VEC_UNLOCK(srcvec);
+    return res;
+}
+
+int sync_to_array_locked(sync_vec_t * vec, void ** resultptr) {
     void * result = calloc(vec->used_slots, vec->element_size);
-    if (!result) {
-        sem_post(&(vec->lock));
+    if (!result) 
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
-    }
 
     memcpy(result, vec->array, vec->used_slots * vec->element_size);
 
     *resultptr = result;
 
-    sem_post(&(vec->lock));
     return VEC_SUCCESS;
 }
+
+int sync_to_array(sync_vec_t * vec, void ** resultptr) {
+    int res;
+    SYNC_VEC_READ_LOCK(vec);
+    res = sync_to_array_locked(vec, resultptr);
+    SYNC_VEC_UNLOCK(vec);
+    return res;
+}
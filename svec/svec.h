@@ -2,28 +2,114 @@
 
 #define SVEC_H
 
-#define VEC_SUCCESS 0
-#define VEC_INDEX_OUT_OF_BOUNDS 1 
-#define VEC_COULD_NOT_ALLOCATE_MEMORY 2
-#define VEC_NOT_FOUND 3
-#define VEC_ALREADY_INITIALIZED 4
-#define VEC_ALREADY_DESTROYED 5
-#define VEC_NULL_BUFFER 6
-
 #include <stdint.h>
 #include <stdlib.h>
-#include <semaphore.h>
+#include <pthread.h>
 #include <string.h>
+#include "../vec_errors.h"
+#include "../vec_types.h"
+#include "../alloc/vec_alloc.h"
+#include "../sort/sort_by.h"
+
+#ifdef VEC_LOCK_STATS
+#include <stdatomic.h>
+
+#define SYNC_VEC_LOCK_BUCKETS 32
+
+/**
+ * what the lock of a sync_vec_t has been through, kept when the library and everything
+ * including svec.h are compiled with -DVEC_LOCK_STATS (cmake -DVEC_LOCK_STATS=ON).
+ * See sync_lock_stats_get.
+ *  read_acquisitions, write_acquisitions: times the lock was taken shared and exclusive
+ *  contended:      acquisitions that found the lock taken and had to wait for it
+ *  wait_ns:        histogram of how long the contended acquisitions waited. Bucket k counts
+ *                  waits from 2^k up to 2^(k+1) nanoseconds, bucket 0 also counts 0 and the
+ *                  last bucket everything longer
+ *  hold_ns:        the same for how long every acquisition held the lock
+ *  total_wait_ns, total_hold_ns: the sums of both
+ *  longest_hold_ns: the longest the lock was held in one go, and where it was taken:
+ *  longest_hold_file, longest_hold_line, longest_hold_func: the lock macro's place in the
+ *                  source, so in svec*.c for the sync_ functions and in your code for the
+ *                  SYNC_VEC_ macros
+ *  longest_hold_caller: the return address of the function that took the lock, which for
+ *                  the sync_ functions is in the code calling them. addr2line or dladdr turn
+ *                  it into a place
+ */
+typedef struct {
+    uint64_t read_acquisitions;
+    uint64_t write_acquisitions;
+    uint64_t contended;
+    uint64_t wait_ns[SYNC_VEC_LOCK_BUCKETS];
+    uint64_t hold_ns[SYNC_VEC_LOCK_BUCKETS];
+    uint64_t total_wait_ns;
+    uint64_t total_hold_ns;
+    uint64_t longest_hold_ns;
+    const char * longest_hold_file;
+    int longest_hold_line;
+    const char * longest_hold_func;
+    void * longest_hold_caller;
+} sync_lock_stats_t;
+
+//the live counters inside the vector, updated by every thread that takes the lock
+struct sync_lock_counters {
+    _Atomic uint64_t read_acquisitions;
+    _Atomic uint64_t write_acquisitions;
+    _Atomic uint64_t contended;
+    _Atomic uint64_t wait_ns[SYNC_VEC_LOCK_BUCKETS];
+    _Atomic uint64_t hold_ns[SYNC_VEC_LOCK_BUCKETS];
+    _Atomic uint64_t total_wait_ns;
+    _Atomic uint64_t total_hold_ns;
+    _Atomic uint64_t longest_hold_ns;
+    //guards the longest hold's call site, which is written rarely
+    atomic_flag longest_lock;
+    const char * longest_hold_file;
+    int longest_hold_line;
+    const char * longest_hold_func;
+    void * longest_hold_caller;
+};
+#endif
 
 typedef struct {
     uint32_t allocated_slots;
     uint32_t used_slots;
     size_t element_size;
-    sem_t lock;
+    vec_policy_t policy;
+    pthread_rwlock_t lock;
+    uint64_t generation;
     void * array;
+    const vec_allocator_t * allocator;
+#ifdef VEC_LOCK_STATS
+    struct sync_lock_counters lock_counters;
+#endif
 } sync_vec_t;
 
-typedef int (*cmpfn)(const void*,const void*);
+/**
+ * every sync_vec_t is guarded by a reader-writer lock. Operations that only read
+ * the vector (sync_get, sync_to_array, sync_copy, SYNC_VEC_FIND_BY, SYNC_VEC_MAP, ...)
+ * take it shared so they run side by side, everything that modifies the vector
+ * takes it exclusive. On glibc the lock prefers writers so a steady stream of
+ * readers cannot starve them.
+ * Taking the lock exclusive bumps the vector's generation, so code that worked on
+ * a copy outside the lock (sync_sort_snapshot) can tell whether anything changed.
+ */
+#ifdef VEC_LOCK_STATS
+/**
+ * take and release the lock like the pthread_rwlock calls, counting and timing it on the way.
+ * Used by the lock macros when compiled with -DVEC_LOCK_STATS, not meant to be called directly.
+ */
+int sync_lock_stats_lock(sync_vec_t * vector, int write, const char * file, int line, const char * func, void * caller);
+int sync_lock_stats_unlock(sync_vec_t * vector);
+
+#define SYNC_VEC_READ_LOCK(vector) \
+        sync_lock_stats_lock(vector, 0, __FILE__, __LINE__, __func__, __builtin_return_address(0))
+#define SYNC_VEC_WRITE_LOCK(vector) \
+        (sync_lock_stats_lock(vector, 1, __FILE__, __LINE__, __func__, __builtin_return_address(0)), (vector)->generation++)
+#define SYNC_VEC_UNLOCK(vector) sync_lock_stats_unlock(vector)
+#else
+#define SYNC_VEC_READ_LOCK(vector) pthread_rwlock_rdlock(&(vector)->lock)
+#define SYNC_VEC_WRITE_LOCK(vector) (pthread_rwlock_wrlock(&(vector)->lock), (vector)->generation++)
+#define SYNC_VEC_UNLOCK(vector) pthread_rwlock_unlock(&(vector)->lock)
+#endif
 
 /**
  * given a pointer to a sync_vec_t struct, and the size of
@@ -39,6 +125,61 @@ typedef int (*cmpfn)(const void*,const void*);
  */
 int sync_init (sync_vec_t * vector, size_t element_size);
 
+/**
+ * same as sync_init, but allocates room for capacity elements up front
+ * so a vector of known size never has to grow.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int sync_init_with_capacity(sync_vec_t * vector, size_t element_size, int capacity);
+
+/**
+ * same as sync_init_with_capacity, but all of the vector's memory comes from allocator
+ * instead of calloc/realloc/free. allocator must outlive the vector. See alloc/vec_alloc.h
+ * for the bump arena and size class pool that come with the library.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int sync_init_with_allocator(sync_vec_t * vector, size_t element_size, int capacity, const vec_allocator_t * allocator);
+
+/**
+ * makes sure the vector has room for at least capacity elements,
+ * growing to exactly that size if it does not.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT
+ */
+int sync_reserve(sync_vec_t * vector, int capacity);
+
+/**
+ * releases any unused slots so the allocation matches the length.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int sync_shrink_to_fit(sync_vec_t * vector);
+
+/**
+ * sets the growth and shrink policy of the vector. Passing NULL restores
+ * the defaults.  The policy is copied, so policy can be a local.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INVALID_ARGUMENT
+ */
+int sync_set_policy(sync_vec_t * vector, vec_policy_t * policy);
+
 /**
  * appends the item pointed to by the element_ptr
  * to the end of the array. grows if needed
@@ -49,6 +190,18 @@ int sync_init (sync_vec_t * vector, size_t element_size);
  */
 int sync_append(sync_vec_t * vector, void * element_ptr); 
 
+/**
+ * appends count items from the elements array to the end of the vector.
+ * grows at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int sync_append_n(sync_vec_t * vector, void * elements, int count);
+
 /**
  * inserts the item pointed to by the element_ptr into
  * the given index, shifting everything else over to the left.
@@ -60,6 +213,18 @@ int sync_append(sync_vec_t * vector, void * element_ptr);
  */
 int sync_insert(sync_vec_t * vector, void * element_ptr, int idx);
 
+/**
+ * inserts count items from the elements array starting at the given index,
+ * shifting everything else over with a single move. grows at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int sync_insert_range(sync_vec_t * vector, void * elements, int count, int idx);
+
 /**
  * overwrites the item at the given index with the contents of the
  * element_ptr buffer. Be sure to not leak memory when using this!
@@ -79,7 +244,7 @@ int sync_veclen(sync_vec_t * vector);
  * removes the given item that is equivalent to the 
  * element pointed to by element_ptr and shifts everything
  * else over to the left. Shrinks the array
- * if less than 1/4 of the allocated space is in use.
+ * if less than 1/4 (or the policy's shrink_divisor) of the allocated space is in use.
  * 
  * possible return values:
  *  VEC_SUCCESS
@@ -92,7 +257,7 @@ int sync_remove_element(sync_vec_t * vector, void * element_ptr);
 /**
  * removes the given item that is at the given index
  * and shifts everything else over to the left. Shrinks the array
- * if less than 1/4 of the allocated space is in use.
+ * if less than 1/4 (or the policy's shrink_divisor) of the allocated space is in use.
  * 
  * possible return values:
  *  VEC_SUCCESS
@@ -101,6 +266,54 @@ int sync_remove_element(sync_vec_t * vector, void * element_ptr);
  */
 int sync_remove_index(sync_vec_t * vector, int idx);
 
+/**
+ * removes count items starting at the given index and shifts everything
+ * else over to the left with a single move. Shrinks the array at most once
+ * if less than 1/4 (or the policy's shrink_divisor) of the allocated space is in use.
+ * 
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ */
+int sync_remove_range(sync_vec_t * vector, int idx, int count);
+
+/**
+ * removes the item at the given index by moving the last item into its place,
+ * so nothing else moves and the removal is O(1). The order of the vector is
+ * not kept. Shrinks the array if less than 1/4 (or the policy's shrink_divisor)
+ * of the allocated space is in use.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ */
+int sync_swap_remove(sync_vec_t * vector, int idx);
+
+/**
+ * finds the first item equivalent to the element pointed to by element_ptr,
+ * like sync_remove_element, and removes it with sync_swap_remove.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ *  VEC_NOT_FOUND
+ */
+int sync_swap_remove_element(sync_vec_t * vector, void * element_ptr);
+
+/**
+ * removes every element from position len on, as one sync_remove_range, so the vector
+ * shrinks at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS if len is negative or larger than the vector
+ */
+int sync_truncate(sync_vec_t * vector, int len);
+
 /**
  * gets the item at the given index and copies it into 
  * the memory pointed to by element_buffer
@@ -129,10 +342,178 @@ int sync_destroy(sync_vec_t * vector);
  */
 int sync_sort(sync_vec_t * vector,cmpfn cmp);
 
+/**
+ * sorts the array in place like sync_sort, but spread over nthreads threads
+ * (nthreads <= 0 uses one per cpu) with the parallel merge sort in sort/psort.h.
+ * The lock is held for the whole sort, only for a shorter time.
+ * Implemented in svec_sort.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int sync_parallel_sort(sync_vec_t * vector, cmpfn cmp, int nthreads);
+
+/**
+ * sorts without blocking other threads for the length of the sort: the array is
+ * copied under the read lock, the copy is sorted with nthreads threads outside the
+ * lock, and the write lock is only taken to swap the sorted copy in.  If another
+ * thread changed the vector in the meantime the sorted copy is stale, so the sort
+ * is retried, and after a couple of tries done under the write lock like
+ * sync_parallel_sort.  Needs memory for two copies of the array while it runs.
+ * Implemented in svec_sort.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int sync_sort_snapshot(sync_vec_t * vector, cmpfn cmp, int nthreads);
+
+/**
+ * sorts the vector by the integer key of key_width bytes (1, 2, 4 or 8) found key_offset
+ * bytes into each element, for example offsetof(struct x, id) and sizeof(uint32_t).
+ * flags is VEC_RADIX_UNSIGNED or VEC_RADIX_SIGNED. An LSD radix sort, so it takes
+ * key_width passes over the data no matter how many elements there are, and skips the
+ * passes for bytes that are the same in every key. Unlike sort it is stable. The scratch
+ * buffer it needs, as large as the array, comes from calloc, not the vector's allocator. The lock is held for the whole sort.
+ * Implemented in svec_sort.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT if key_width is not 1, 2, 4 or 8, or the key does not fit in the element
+ */
+int sync_radix_sort(sync_vec_t * vector, size_t key_offset, size_t key_width, int flags);
+
+/**
+ * the functions below work on a vector kept sorted by cmp, for example with sync_sort
+ * and then only changed through sync_insert_sorted, sync_remove_sorted and sync_merge_sorted.
+ * They find positions with a binary search instead of a scan. cmp is called like
+ * bsearch's, as cmp(key, element), so key can be a full element or just enough of
+ * one for cmp to look at. Lookups take the lock shared, changes exclusive.
+ */
+
+/**
+ * sets idx to the first position whose element is not less than key,
+ * veclen(vector) if there is none. Always finds a position.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NULL_BUFFER
+ */
+int sync_lower_bound(sync_vec_t * vector, void * key, cmpfn cmp, int * idx);
+
+/**
+ * sets idx to the first position whose element is greater than key,
+ * veclen(vector) if there is none. Always finds a position.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NULL_BUFFER
+ */
+int sync_upper_bound(sync_vec_t * vector, void * key, cmpfn cmp, int * idx);
+
+/**
+ * sets idx to the position of the first element equal to key. If there is
+ * none, idx is set to where key would be inserted instead.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ *  VEC_NULL_BUFFER
+ */
+int sync_bsearch(sync_vec_t * vector, void * key, cmpfn cmp, int * idx);
+
+/**
+ * inserts the item pointed to by element_ptr where it keeps the vector sorted,
+ * after any elements equal to it.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int sync_insert_sorted(sync_vec_t * vector, void * element_ptr, cmpfn cmp);
+
+/**
+ * removes the first element equal to the one pointed to by element_ptr,
+ * shrinking like sync_remove_index.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NOT_FOUND
+ *  VEC_NULL_BUFFER
+ */
+int sync_remove_sorted(sync_vec_t * vector, void * element_ptr, cmpfn cmp);
+
+/**
+ * adds count unsorted items from the elements array, keeping the vector sorted.
+ * A copy of the batch is sorted in scratch space from calloc, then
+ * merged in from the back, so every element moves at most once: O(m log m + n)
+ * instead of the O(m * n) of m calls to sync_insert_sorted. The elements array is not
+ * changed. Elements already in the vector stay in front of equal ones from the batch.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS if count is negative
+ *  VEC_NULL_BUFFER
+ */
+int sync_merge_sorted(sync_vec_t * vector, void * elements, int count, cmpfn cmp);
+
+/**
+ * parallel versions of VEC_MAP, VEC_FILTER and a reduce, for costly per element work
+ * on large vectors. The array is cut into chunks of about 256KB that the threads of a
+ * shared pool (started on first use, see par/vec_par.h) take in turn. The order of the
+ * elements is kept, and vectors under VEC_PAR_MIN (32768) elements are done by the
+ * calling thread alone. The functions passed in are called from several threads at
+ * once, so they must not change shared state without synchronizing.
+ * Implemented in svec_parallel.c, link with -lpthread.
+ */
+
+/**
+ * initializes dst with room for every element of src and calls fn(src_element, dst_element, ctx)
+ * on each element of src to fill out the matching element of dst. dst must be uninitialized,
+ * its memory comes from dst->allocator, which may be set on the zeroed vector beforehand. The source is read locked while it runs.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int sync_parallel_map(sync_vec_t * src, sync_vec_t * dst, size_t dst_element_size, vec_map_fn fn, void * ctx);
+
+/**
+ * removes every element pred(element, ctx) returns false for, keeping the order
+ * of the rest, and shrinks at most once. Holds the lock for the whole call.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int sync_parallel_filter(sync_vec_t * vector, vec_pred_fn pred, void * ctx);
+
+/**
+ * folds every element into the result_size bytes at result with fn(acc, element, ctx).
+ * result must hold the identity value of the reduction (0 for a sum) on entry: every
+ * chunk is folded into its own copy of it, and the chunk results are then folded into
+ * result in order with combine(acc, other, ctx). fn and combine must be associative,
+ * they need not be commutative. The vector is read locked while it runs.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int sync_parallel_reduce(sync_vec_t * vector, void * result, size_t result_size,
+        vec_reduce_fn fn, vec_combine_fn combine, void * ctx);
+
 /**
  * creates a copy of the vector. The source vector should have already been
  * initialized, while the destination vector should already be allocated but
- * not initalized
+ * not initalized. The copy's memory comes from dstvec->allocator, which may be
+ * set on the zeroed destination beforehand.
  *
  * possible return values:
  *  VEC_SUCCESS
@@ -154,10 +535,157 @@ int sync_copy(sync_vec_t * srcvec, sync_vec_t * dstvec);
 int sync_to_array(sync_vec_t * vec, void ** resultptr);
 
 /**
- * not intended for use outside of macros. this version of remove does not take the lock so its caller can take the lock for it.
- * This means the caller macro can hold the lock and call remove without deadlocking itself
+ * writes the vector to fd in the chunked stream format from io/vec_stream.h.
+ * The read lock is only held while each chunk is copied out, never during I/O, so
+ * other threads keep going while a large vector is saved.  That also means the file
+ * is not a point in time snapshot if other threads write meanwhile; wrap the call in
+ * your own synchronization if that matters.  fd is left open.  Implemented in svec_io.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_IO_ERROR
+ *  VEC_NULL_BUFFER
+ */
+int sync_save(sync_vec_t * vector, int fd);
+
+/**
+ * reads a vector written by sync_save (or vec_save) from fd into an uninitialized vector,
+ * taking the write lock once per chunk.  If vector->allocator is set it is used for the
+ * array.  On failure the vector is left uninitialized.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_IO_ERROR
+ *  VEC_BAD_FORMAT if the stream is truncated, corrupt or not a vector
+ */
+int sync_load(sync_vec_t * vector, int fd);
+
+#ifdef VEC_LOCK_STATS
+/**
+ * copies what the vector's lock has been through into stats. Only there when compiled
+ * with -DVEC_LOCK_STATS. It does not take the lock, so it can be called while other
+ * threads hold it; the counters are each read atomically but not all at one instant.
+ * sync_destroy clears them, so read them before.  Implemented in svec_lock_stats.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NULL_BUFFER
+ */
+int sync_lock_stats_get(sync_vec_t * vector, sync_lock_stats_t * stats);
+
+/**
+ * zeroes the vector's lock counters and forgets the longest hold.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int sync_lock_stats_reset(sync_vec_t * vector);
+#endif
+
+/**
+ * takes the lock exclusively so a group of operations can be done as one
+ * unit, without other threads interleaving and without paying for the lock on every call.
+ * Between sync_begin and sync_commit only use the *_locked functions below, plain
+ * sync_* functions and SYNC_VEC_* macros would try to take the lock again and deadlock.
+ * There is no rollback, commit just releases the lock.
+ *
+ * Example:
+ *      sync_begin(vector);
+ *      for (i = 0; i < 100; i++)
+ *          sync_append_locked(vector, &i);
+ *      sync_sort_locked(vector, cmp);
+ *      sync_commit(vector);
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int sync_begin(sync_vec_t * vector);
+
+/**
+ * releases the lock taken by sync_begin.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int sync_commit(sync_vec_t * vector);
+
+/**
+ * same as sync_begin, but takes the lock shared, for a group of reads that must
+ * see the same state. Only the read-only *_locked functions may be used until sync_end_read.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int sync_begin_read(sync_vec_t * vector);
+
+/**
+ * releases the lock taken by sync_begin_read.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int sync_end_read(sync_vec_t * vector);
+
+/**
+ * versions of the functions above that do not take the lock, for use between
+ * sync_begin and sync_commit (or sync_begin_read and sync_end_read for the
+ * read-only ones: get, copy, to_array, lower_bound, upper_bound and bsearch).
+ * They behave and fail exactly like the function of the same name without _locked.
+ */
+int sync_append_locked(sync_vec_t * vector, void * element_ptr);
+int sync_append_n_locked(sync_vec_t * vector, void * elements, int count);
+int sync_insert_locked(sync_vec_t * vector, void * element_ptr, int idx);
+int sync_insert_range_locked(sync_vec_t * vector, void * elements, int count, int idx);
+int sync_replace_locked(sync_vec_t * vector, void * element_ptr, int idx);
+int sync_remove_element_locked(sync_vec_t * vector, void * element_ptr);
+int sync_remove_index_locked(sync_vec_t * vector, int idx);
+int sync_remove_range_locked(sync_vec_t * vector, int idx, int count);
+int sync_swap_remove_locked(sync_vec_t * vector, int idx);
+int sync_swap_remove_element_locked(sync_vec_t * vector, void * element_ptr);
+int sync_truncate_locked(sync_vec_t * vector, int len);
+int sync_get_locked(sync_vec_t * vector, int idx, void * element_buffer);
+int sync_sort_locked(sync_vec_t * vector, cmpfn cmp);
+int sync_parallel_sort_locked(sync_vec_t * vector, cmpfn cmp, int nthreads);
+int sync_radix_sort_locked(sync_vec_t * vector, size_t key_offset, size_t key_width, int flags);
+int sync_lower_bound_locked(sync_vec_t * vector, void * key, cmpfn cmp, int * idx);
+int sync_upper_bound_locked(sync_vec_t * vector, void * key, cmpfn cmp, int * idx);
+int sync_bsearch_locked(sync_vec_t * vector, void * key, cmpfn cmp, int * idx);
+int sync_insert_sorted_locked(sync_vec_t * vector, void * element_ptr, cmpfn cmp);
+int sync_remove_sorted_locked(sync_vec_t * vector, void * element_ptr, cmpfn cmp);
+int sync_merge_sorted_locked(sync_vec_t * vector, void * elements, int count, cmpfn cmp);
+int sync_copy_locked(sync_vec_t * srcvec, sync_vec_t * dstvec);
+int sync_to_array_locked(sync_vec_t * vec, void ** resultptr);
+int sync_reserve_locked(sync_vec_t * vector, int capacity);
+int sync_shrink_to_fit_locked(sync_vec_t * vector);
+int sync_set_policy_locked(sync_vec_t * vector, vec_policy_t * policy);
+
+/**
+ * same as sync_remove_index_locked, kept for existing callers. vec.h declares its own
+ * remove_index, so this one is left out when vec.h is included first; include vec.h
+ * before svec.h to use both headers in one file.
  */
+#ifndef VEC_H
 int remove_index(sync_vec_t * vector, int idx);
+#endif
+
+/*
+ * ends the single pass compaction in SYNC_VEC_FILTER and SYNC_VEC_ITER_REMOVE. The _keep
+ * elements kept so far are at the front; if the loop was left early with break, everything
+ * from _i on is kept as well and slides down behind them. Then the vector is cut to length,
+ * shrinking at most once. Evaluates to the result. The lock must be held.
+ */
+#define _SYNC_VEC_COMPACT_FINISH(vector, _i, _keep) ({\
+        if ((_i) < (vector)->used_slots) {\
+            memmove((vector)->array + (_keep) * (vector)->element_size,\
+                    (vector)->array + (_i) * (vector)->element_size,\
+                    ((vector)->used_slots - (_i)) * (vector)->element_size);\
+            (_keep) += (vector)->used_slots - (_i);\
+        }\
+        sync_truncate_locked(vector, _keep);\
+})
 
 /**
  * finds the element in the vector based on the given condition.
@@ -178,7 +706,7 @@ int remove_index(sync_vec_t * vector, int idx);
  *  VEC_NOT_FOUND
  */
 #define SYNC_VEC_FIND_BY(vector, element_buffer, condition) ({\
-        sem_wait(&(vector)->lock);\
+        SYNC_VEC_READ_LOCK(vector);\
         int _ret = VEC_NOT_FOUND; \
         unsigned int _i;\
         for (_i = 0; _i < (vector)->used_slots; _i++) { \
@@ -188,7 +716,38 @@ int remove_index(sync_vec_t * vector, int idx);
                 break; \
             } \
         } \
-        sem_post(&(vector)->lock);\
+        SYNC_VEC_UNLOCK(vector);\
+        _ret; \
+})
+
+/**
+ * same as SYNC_VEC_FIND_BY, but tests the elements where they are instead of copying each one out.
+ * element_ptr is a x* variable, where x is the type that you are storing. On success
+ * it is left pointing at the found element inside the vector.  It does not take the lock:
+ * call it between sync_begin_read and sync_end_read (or sync_begin and sync_commit) and
+ * only use the pointer until the lock is released, after which any write may move or free it.
+ *
+ * Example:
+ *      struct x * ptr;
+ *      sync_begin_read(vector);
+ *      if (SYNC_VEC_FIND_BY_PTR_LOCKED(vector, ptr, ptr->y == 1) == VEC_SUCCESS)
+ *          total += ptr->z;
+ *      sync_end_read(vector);
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ */
+#define SYNC_VEC_FIND_BY_PTR_LOCKED(vector, element_ptr, condition) ({\
+        int _ret = VEC_NOT_FOUND; \
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) { \
+            element_ptr = (vector)->array + _i * (vector)->element_size; \
+            if (condition) { \
+                _ret = VEC_SUCCESS; \
+                break; \
+            } \
+        } \
         _ret; \
 })
 
@@ -202,67 +761,111 @@ int remove_index(sync_vec_t * vector, int idx);
  *  VEC_NOT_FOUND
  */
 #define SYNC_VEC_REMOVE_BY(vector, element_buffer, condition) ({\
-        sem_wait(&(vector)->lock);\
+        SYNC_VEC_WRITE_LOCK(vector);\
         int _ret = VEC_NOT_FOUND; \
         unsigned int _i;\
             for (_i = 0; _i < (vector)->used_slots; _i++) { \
                 memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size); \
                 if (condition) { \
                     _ret = VEC_SUCCESS; \
-                    remove_index(vector, _i); \
+                    sync_remove_index_locked(vector, _i); \
                     break; \
                 } \
         } \
-        sem_post(&(vector)->lock);\
+        SYNC_VEC_UNLOCK(vector);\
+        _ret; \
+})
+
+/**
+ * same as SYNC_VEC_REMOVE_BY, but removes the element with sync_swap_remove_locked,
+ * so the last element takes its place instead of everything after it shifting over.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ */
+#define SYNC_VEC_SWAP_REMOVE_BY(vector, element_buffer, condition) ({\
+        SYNC_VEC_WRITE_LOCK(vector);\
+        int _ret = VEC_NOT_FOUND; \
+        unsigned int _i;\
+            for (_i = 0; _i < (vector)->used_slots; _i++) { \
+                memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size); \
+                if (condition) { \
+                    _ret = VEC_SUCCESS; \
+                    sync_swap_remove_locked(vector, _i); \
+                    break; \
+                } \
+        } \
+        SYNC_VEC_UNLOCK(vector);\
         _ret; \
 })
 
 /**
  * creates a copy of the first vector and stores it in the second vector.
- * The copy keeps only the elements that satisfy the condition.
+ * The copy keeps only the elements that satisfy the condition, which are the only
+ * ones ever copied into it.  It gets the source's policy, and its memory comes from
+ * dstvector->allocator, which may be set on the zeroed destination beforehand.
  * srcvector is an initialized sync_vec_t * , dstvector is an uninitailized sync_vec_t *. 
  * element_buffer is a x*, where x is the type that you are storing. 
  * condition is a boolean expression involving your element_buffer.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
  */
 #define SYNC_VEC_SELECT(srcvector, dstvector, element_buffer, condition) ({\
-        sem_wait(&(srcvector)->lock);\
+        int _ret;\
         unsigned int _i;\
-        copy(srcvector, dstvector); \
-        for (_i = 0; _i < (dstvector)->used_slots; _i++) {\
-            memcpy(element_buffer, (dstvector)->array + _i * (dstvector)->element_size, (dstvector)->element_size); \
-            if (!(condition)) { \
-                remove_index(dstvector, _i); \
-                _i--;\
-            }\
+        const vec_allocator_t * _allocator = (dstvector)->allocator;\
+        SYNC_VEC_READ_LOCK(srcvector);\
+        _ret = sync_init(dstvector, (srcvector)->element_size); \
+        /* an initialized destination is left alone, policy included */\
+        if (_ret == VEC_SUCCESS)\
+            (dstvector)->policy = (srcvector)->policy;\
+        for (_i = 0; _ret == VEC_SUCCESS && _i < (srcvector)->used_slots; _i++) {\
+            memcpy(element_buffer, (srcvector)->array + _i * (srcvector)->element_size, (srcvector)->element_size); \
+            if (condition) \
+                _ret = sync_append_locked(dstvector, (srcvector)->array + _i * (srcvector)->element_size); \
+        }\
+        SYNC_VEC_UNLOCK(srcvector);\
+        /* on failure leave the destination as it was handed in, allocator included */\
+        if (_ret != VEC_SUCCESS && _ret != VEC_ALREADY_INITIALIZED) {\
+            sync_destroy(dstvector);\
+            (dstvector)->allocator = _allocator;\
         }\
-        sem_post(&(srcvector)->lock);\
-        VEC_SUCCESS;\
+        _ret;\
 })
 
 /**
  * The removes the elements that do not satisfy the condition.
+ * The kept elements slide down in a single pass, keeping their order,
+ * and the vector shrinks at most once at the end.
  * vector is an initialized sync_vec_t *. 
  * element_buffer is a x*, where x is the type that you are storing. 
  * condition is a boolean expression involving your element_buffer.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
  */
 #define SYNC_VEC_FILTER(vector, element_buffer, condition) ({\
-        sem_wait(&(vector)->lock);\
-        unsigned int _i;\
+        int _ret;\
+        unsigned int _i, _keep = 0;\
+        size_t _es;\
+        SYNC_VEC_WRITE_LOCK(vector);\
+        _es = (vector)->element_size;\
         for (_i = 0; _i < (vector)->used_slots; _i++) {\
-            memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size); \
-            if (!(condition)) { \
-                remove_index(vector, _i); \
-                _i--;\
+            memcpy(element_buffer, (vector)->array + _i * _es, _es); \
+            if (condition) { \
+                if (_keep != _i) \
+                    memcpy((vector)->array + _keep * _es, (vector)->array + _i * _es, _es); \
+                _keep++;\
             }\
         }\
-        sem_post(&(vector)->lock);\
-        VEC_SUCCESS;\
+        _ret = _SYNC_VEC_COMPACT_FINISH(vector, _i, _keep);\
+        SYNC_VEC_UNLOCK(vector);\
+        _ret;\
 })
 
 /**
@@ -294,7 +897,7 @@ int remove_index(sync_vec_t * vector, int idx);
  *  VEC_ALREADY_INITIALIZED
  */
 #define SYNC_VEC_MAP(srcvector, dstvector, mapped_ele_size, src_element_buffer, dst_element_buffer, expression) ({\
-        sem_wait(&(srcvector)->lock);\
+        SYNC_VEC_READ_LOCK(srcvector);\
         int _ret = VEC_SUCCESS; \
         unsigned int _i;\
         if ((dstvector)->array != NULL && (dstvector)->allocated_slots > 0)  \
@@ -303,7 +906,7 @@ int remove_index(sync_vec_t * vector, int idx);
             (dstvector)->element_size = mapped_ele_size; \
             (dstvector)->used_slots = (srcvector)->used_slots;\
             (dstvector)->allocated_slots = (srcvector)->allocated_slots;\
-            (dstvector)->array = calloc((srcvector)->allocated_slots, mapped_ele_size);\
+            (dstvector)->array = vec_mem_alloc((dstvector)->allocator, (size_t)(srcvector)->allocated_slots * (mapped_ele_size));\
             if ((dstvector)->array == NULL) \
                 _ret = VEC_COULD_NOT_ALLOCATE_MEMORY; \
             else { \
@@ -314,7 +917,43 @@ int remove_index(sync_vec_t * vector, int idx);
                 }\
             } \
         }\
-        sem_post(&(srcvector)->lock);\
+        SYNC_VEC_UNLOCK(srcvector);\
+        _ret;\
+})
+
+/**
+ * same as SYNC_VEC_MAP, but works on the elements in place instead of going through buffers.
+ * src_element_ptr is a x* variable and dst_element_ptr is a y* variable. expression
+ * reads from src_element_ptr and fills out dst_element_ptr, which points straight into
+ * the new vector.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+#define SYNC_VEC_MAP_PTR(srcvector, dstvector, mapped_ele_size, src_element_ptr, dst_element_ptr, expression) ({\
+        SYNC_VEC_READ_LOCK(srcvector);\
+        int _ret = VEC_SUCCESS; \
+        unsigned int _i;\
+        if ((dstvector)->array != NULL && (dstvector)->allocated_slots > 0)  \
+            _ret = VEC_ALREADY_INITIALIZED; \
+        else {\
+            (dstvector)->element_size = mapped_ele_size; \
+            (dstvector)->used_slots = (srcvector)->used_slots;\
+            (dstvector)->allocated_slots = (srcvector)->allocated_slots;\
+            (dstvector)->array = vec_mem_alloc((dstvector)->allocator, (size_t)(srcvector)->allocated_slots * (mapped_ele_size));\
+            if ((dstvector)->array == NULL) \
+                _ret = VEC_COULD_NOT_ALLOCATE_MEMORY; \
+            else { \
+                for (_i = 0; _i < (srcvector)->used_slots; _i++) {\
+                    src_element_ptr = (srcvector)->array + _i * (srcvector)->element_size; \
+                    dst_element_ptr = (dstvector)->array + _i * (dstvector)->element_size; \
+                    expression\
+                }\
+            } \
+        }\
+        SYNC_VEC_UNLOCK(srcvector);\
         _ret;\
 })
 #endif
@@ -330,7 +969,7 @@ int remove_index(sync_vec_t * vector, int idx);
  *  VEC_SUCCESS
  */
 #define SYNC_VEC_ITER(vector, element_buffer, expression) ({\
-        sem_wait(&(vector)->lock);\
+        SYNC_VEC_WRITE_LOCK(vector);\
         int _ret = VEC_SUCCESS;\
         unsigned int _i;\
         for (_i = 0; _i < (vector)->used_slots; _i++) {\
@@ -338,7 +977,28 @@ int remove_index(sync_vec_t * vector, int idx);
             expression;\
             memcpy((vector)->array + _i * (vector)->element_size, element_buffer,(vector)->element_size);\
         }\
-        sem_post(&(vector)->lock);\
+        SYNC_VEC_UNLOCK(vector);\
+        _ret;\
+})
+
+/**
+ * same as SYNC_VEC_ITER, but element_ptr is a x * variable that is pointed at each element
+ * in turn instead of a buffer that gets filled out and copied back.  Changes made
+ * through element_ptr go straight into the vector.  break will work to end early.
+ * Do not add or remove elements from inside the expression.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define SYNC_VEC_ITER_PTR(vector, element_ptr, expression) ({\
+        SYNC_VEC_WRITE_LOCK(vector);\
+        int _ret = VEC_SUCCESS;\
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            element_ptr = (vector)->array + _i * (vector)->element_size;\
+            expression;\
+        }\
+        SYNC_VEC_UNLOCK(vector);\
         _ret;\
 })
 
@@ -366,26 +1026,64 @@ int remove_index(sync_vec_t * vector, int idx);
  * last thing in the expression should be a boolean with no trailing semicolon.
  * vector is a sync_vec_t *, element_buffer is a x *, where x is the type being stored.
  * expression is any code you choose to execute, that will have the variable *exlement_buffer
- * availible and filled out with a given element.  break will work to end early.
+ * availible and filled out with a given element.  break will work to end early,
+ * keeping the current element and everything after it unchanged.  Like VEC_FILTER
+ * this is a single pass that shrinks at most once at the end.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
  */
 #define SYNC_VEC_ITER_REMOVE(vector, element_buffer, expression) ({\
-        sem_wait(&(vector)->lock);\
-        int _ret = VEC_SUCCESS;\
-        unsigned int _i;\
+        int _ret;\
+        unsigned int _i, _keep = 0;\
+        size_t _es;\
+        SYNC_VEC_WRITE_LOCK(vector);\
+        _es = (vector)->element_size;\
         for (_i = 0; _i < (vector)->used_slots; _i++) {\
-            memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size);\
-            if(expression){\
-                remove_index(vector, _i); \
-                _i--;\
+            memcpy(element_buffer, (vector)->array + _i * _es, _es);\
+            if(!(expression)){\
+                memcpy((vector)->array + _keep * _es, element_buffer, _es);\
+                _keep++;\
             }\
-            else {\
-                memcpy((vector)->array + _i * (vector)->element_size, element_buffer,(vector)->element_size);\
+        }\
+        _ret = _SYNC_VEC_COMPACT_FINISH(vector, _i, _keep);\
+        SYNC_VEC_UNLOCK(vector);\
+        _ret;\
+})
+
+/**
+ * same as SYNC_VEC_ITER_REMOVE, but does not keep the order of the vector. Every removed
+ * element is replaced by the last element not visited yet, which is visited next, so
+ * only one element moves per removal instead of every kept element sliding down.
+ * Elements the expression keeps are copied back in place. break ends early, keeping
+ * the current element and every element not visited yet. Do not use continue.
+ * Holds the write lock throughout and shrinks at most once at the end.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+#define SYNC_VEC_ITER_SWAP_REMOVE(vector, element_buffer, expression) ({\
+        int _ret;\
+        unsigned int _i = 0, _end;\
+        size_t _es;\
+        SYNC_VEC_WRITE_LOCK(vector);\
+        _end = (vector)->used_slots;\
+        _es = (vector)->element_size;\
+        while (_i < _end) {\
+            memcpy(element_buffer, (vector)->array + _i * _es, _es);\
+            if(expression){\
+                _end--;\
+                memcpy((vector)->array + _i * _es, (vector)->array + _end * _es, _es);\
+            } else {\
+                memcpy((vector)->array + _i * _es, element_buffer, _es);\
+                _i++;\
             }\
         }\
-        sem_post(&(vector)->lock);\
+        /* everything from _end on was removed */\
+        _ret = sync_truncate_locked(vector, _end);\
+        SYNC_VEC_UNLOCK(vector);\
         _ret;\
 })
 
@@ -399,7 +1097,7 @@ int remove_index(sync_vec_t * vector, int idx);
  *  VEC_NOT_FOUND
  */
 #define SYNC_VEC_REPLACE_BY(vector, element_buffer, element, condition) ({\
-        sem_wait(&(vector)->lock);\
+        SYNC_VEC_WRITE_LOCK(vector);\
         int _ret = VEC_NOT_FOUND; \
         unsigned int _i;\
             for (_i = 0; _i < (vector)->used_slots; _i++) { \
@@ -410,6 +1108,36 @@ int remove_index(sync_vec_t * vector, int idx);
                     break; \
                 } \
         } \
-        sem_post(&(vector)->lock);\
+        SYNC_VEC_UNLOCK(vector);\
         _ret; \
 })
+
+/**
+ * sorts the vector in place with an introsort generated for the element type T,
+ * so every comparison is inlined instead of going through a cmpfn like sort does.
+ * vector is a sync_vec_t *. a and b are names for two T * variables the macro declares,
+ * and less_expr is a boolean expression that is true when *a belongs before *b.
+ * See sort/sort_by.h for how it works.  Not stable.
+ *
+ * Example:
+ *      struct x {
+ *          int y;
+ *          int z;
+ *      }
+ *
+ *      SYNC_VEC_SORT_BY(vector, struct x, a, b, a->y < b->y);
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_INVALID_ARGUMENT if sizeof(T) is not the vector's element size
+ */
+#define SYNC_VEC_SORT_BY(vector, T, a, b, less_expr) ({\
+        SYNC_VEC_WRITE_LOCK(vector);\
+        int _ret = VEC_INVALID_ARGUMENT;\
+        if (sizeof(T) == (vector)->element_size) {\
+            VEC_SORT_ARRAY_BY(T, (T *)(vector)->array, (vector)->used_slots, a, b, less_expr);\
+            _ret = VEC_SUCCESS;\
+        }\
+        SYNC_VEC_UNLOCK(vector);\
+        _ret;\
+})
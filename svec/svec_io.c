@@ -0,0 +1,105 @@
+#include <limits.h>
+#include "svec.h"
+#include "../io/vec_stream.h"
+
+int sync_save(sync_vec_t * vector, int fd) {
+    vec_writer_t writer;
+    uint32_t per_chunk, count, written = 0;
+    size_t element_size;
+    void * scratch;
+    int res;
+
+    SYNC_VEC_READ_LOCK(vector);
+    element_size = vector->element_size;
+    count = vector->used_slots;
+    res = vector->array == NULL ? VEC_NULL_BUFFER : VEC_SUCCESS;
+    SYNC_VEC_UNLOCK(vector);
+
+    if (res)
+        return res;
+
+    per_chunk = vec_stream_chunk_elements(element_size);
+    scratch = malloc((size_t)per_chunk * element_size);
+    if (scratch == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    if ((res = vec_writer_open(&writer, fd, element_size, count)))
+        goto out;
+
+    while (1) {
+        //only hold the lock for the copy, the write can take as long as it likes
+        SYNC_VEC_READ_LOCK(vector);
+        count = 0;
+        if (written < vector->used_slots) {
+            count = vector->used_slots - written;
+            if (count > per_chunk)
+                count = per_chunk;
+            memcpy(scratch, vector->array + (size_t)written * element_size, (size_t)count * element_size);
+        }
+        SYNC_VEC_UNLOCK(vector);
+
+        if (count == 0)
+            break;
+
+        if ((res = vec_writer_write(&writer, scratch, count)))
+            goto out;
+        written += count;
+    }
+
+    res = vec_writer_close(&writer);
+
+out:
+    free(scratch);
+    return res;
+}
+
+int sync_load(sync_vec_t * vector, int fd) {
+    const vec_allocator_t * allocator;
+    vec_reader_t reader;
+    uint32_t count;
+    int res;
+
+    //check already initialized
+    if (vector->array != NULL && vector->allocated_slots > 0) 
+        return VEC_ALREADY_INITIALIZED;
+
+    if ((res = vec_reader_open(&reader, fd)))
+        return res;
+
+    if (reader.count_hint > INT_MAX)
+        return VEC_BAD_FORMAT;
+
+    //the hint lets a well formed stream load with a single allocation
+    if ((res = sync_init_with_capacity(vector, reader.element_size, (int)reader.count_hint)))
+        return res;
+
+    while (1) {
+        if ((res = vec_reader_next_chunk(&reader, &count)))
+            break;
+        if (count == 0)
+            return VEC_SUCCESS;
+
+        SYNC_VEC_WRITE_LOCK(vector);
+        if ((uint64_t)vector->used_slots + count > INT_MAX)
+            res = VEC_BAD_FORMAT;
+        else
+            res = sync_reserve_locked(vector, vector->used_slots + count);
+
+        //read the chunk right into its place in the array
+        if (res == VEC_SUCCESS)
+            res = vec_reader_read_chunk(&reader, vector->array + (size_t)vector->used_slots * vector->element_size);
+        if (res == VEC_SUCCESS)
+            vector->used_slots += count;
+        SYNC_VEC_UNLOCK(vector);
+
+        if (res)
+            break;
+    }
+
+    //leave the vector as it was handed in, allocator included
+    allocator = vector->allocator;
+    sync_destroy(vector);
+    vector->allocator = allocator;
+
+    return res;
+}
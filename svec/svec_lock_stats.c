@@ -0,0 +1,166 @@
+#include <errno.h>
+#include <time.h>
+#include "svec.h"
+
+#ifdef VEC_LOCK_STATS
+
+//how many locks one thread can hold at once and still have each hold timed
+#define MAX_HELD 16
+
+//a lock this thread holds, from when it got it
+typedef struct {
+    sync_vec_t * vector;
+    uint64_t start;
+    const char * file;
+    int line;
+    const char * func;
+    void * caller;
+} held_t;
+
+static _Thread_local held_t held[MAX_HELD];
+static _Thread_local int held_count;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+//histogram bucket of a time, the bit length of ns
+static int bucket(uint64_t ns) {
+    int k;
+
+    if (ns == 0)
+        return 0;
+    k = 63 - __builtin_clzll(ns);
+    return k < SYNC_VEC_LOCK_BUCKETS ? k : SYNC_VEC_LOCK_BUCKETS - 1;
+}
+
+static void count(_Atomic uint64_t * counter, uint64_t n) {
+    atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+int sync_lock_stats_lock(sync_vec_t * vector, int write, const char * file, int line, const char * func, void * caller) {
+    struct sync_lock_counters * c = &vector->lock_counters;
+    uint64_t start, wait;
+    int res;
+
+    //try first, so only a lock that is already taken costs clock reads to time the wait
+    res = write ? pthread_rwlock_trywrlock(&vector->lock) : pthread_rwlock_tryrdlock(&vector->lock);
+    if (res == EBUSY) {
+        start = now_ns();
+        res = write ? pthread_rwlock_wrlock(&vector->lock) : pthread_rwlock_rdlock(&vector->lock);
+        if (res != 0)
+            return res;
+
+        wait = now_ns() - start;
+        start += wait;
+        count(&c->contended, 1);
+        count(&c->wait_ns[bucket(wait)], 1);
+        count(&c->total_wait_ns, wait);
+    } else if (res != 0) {
+        return res;
+    } else {
+        start = now_ns();
+    }
+
+    count(write ? &c->write_acquisitions : &c->read_acquisitions, 1);
+
+    if (held_count < MAX_HELD)
+        held[held_count++] = (held_t){vector, start, file, line, func, caller};
+
+    return 0;
+}
+
+int sync_lock_stats_unlock(sync_vec_t * vector) {
+    struct sync_lock_counters * c = &vector->lock_counters;
+    uint64_t hold;
+    int i;
+
+    //the most recent hold of this vector by this thread, missing only if too many were nested
+    for (i = held_count - 1; i >= 0 && held[i].vector != vector; i--)
+        ;
+
+    //counted before the lock is released, after that the vector may be destroyed
+    if (i >= 0) {
+        hold = now_ns() - held[i].start;
+        count(&c->hold_ns[bucket(hold)], 1);
+        count(&c->total_hold_ns, hold);
+
+        if (hold > atomic_load_explicit(&c->longest_hold_ns, memory_order_relaxed)) {
+            while (atomic_flag_test_and_set_explicit(&c->longest_lock, memory_order_acquire))
+                ;
+            //check again, another thread may have recorded a longer one meanwhile
+            if (hold > atomic_load_explicit(&c->longest_hold_ns, memory_order_relaxed)) {
+                atomic_store_explicit(&c->longest_hold_ns, hold, memory_order_relaxed);
+                c->longest_hold_file = held[i].file;
+                c->longest_hold_line = held[i].line;
+                c->longest_hold_func = held[i].func;
+                c->longest_hold_caller = held[i].caller;
+            }
+            atomic_flag_clear_explicit(&c->longest_lock, memory_order_release);
+        }
+
+        memmove(&held[i], &held[i + 1], (held_count - i - 1) * sizeof(held_t));
+        held_count--;
+    }
+
+    return pthread_rwlock_unlock(&vector->lock);
+}
+
+int sync_lock_stats_get(sync_vec_t * vector, sync_lock_stats_t * stats) {
+    struct sync_lock_counters * c = &vector->lock_counters;
+    int k;
+
+    if (stats == NULL)
+        return VEC_NULL_BUFFER;
+
+    stats->read_acquisitions = atomic_load(&c->read_acquisitions);
+    stats->write_acquisitions = atomic_load(&c->write_acquisitions);
+    stats->contended = atomic_load(&c->contended);
+    for (k = 0; k < SYNC_VEC_LOCK_BUCKETS; k++) {
+        stats->wait_ns[k] = atomic_load(&c->wait_ns[k]);
+        stats->hold_ns[k] = atomic_load(&c->hold_ns[k]);
+    }
+    stats->total_wait_ns = atomic_load(&c->total_wait_ns);
+    stats->total_hold_ns = atomic_load(&c->total_hold_ns);
+
+    //the longest hold and its call site are read together
+    while (atomic_flag_test_and_set_explicit(&c->longest_lock, memory_order_acquire))
+        ;
+    stats->longest_hold_ns = atomic_load(&c->longest_hold_ns);
+    stats->longest_hold_file = c->longest_hold_file;
+    stats->longest_hold_line = c->longest_hold_line;
+    stats->longest_hold_func = c->longest_hold_func;
+    stats->longest_hold_caller = c->longest_hold_caller;
+    atomic_flag_clear_explicit(&c->longest_lock, memory_order_release);
+
+    return VEC_SUCCESS;
+}
+
+int sync_lock_stats_reset(sync_vec_t * vector) {
+    struct sync_lock_counters * c = &vector->lock_counters;
+    int k;
+
+    atomic_store(&c->read_acquisitions, 0);
+    atomic_store(&c->write_acquisitions, 0);
+    atomic_store(&c->contended, 0);
+    for (k = 0; k < SYNC_VEC_LOCK_BUCKETS; k++) {
+        atomic_store(&c->wait_ns[k], 0);
+        atomic_store(&c->hold_ns[k], 0);
+    }
+    atomic_store(&c->total_wait_ns, 0);
+    atomic_store(&c->total_hold_ns, 0);
+
+    while (atomic_flag_test_and_set_explicit(&c->longest_lock, memory_order_acquire))
+        ;
+    atomic_store(&c->longest_hold_ns, 0);
+    c->longest_hold_file = NULL;
+    c->longest_hold_line = 0;
+    c->longest_hold_func = NULL;
+    c->longest_hold_caller = NULL;
+    atomic_flag_clear_explicit(&c->longest_lock, memory_order_release);
+
+    return VEC_SUCCESS;
+}
+#endif
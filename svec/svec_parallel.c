@@ -0,0 +1,44 @@
+#include "svec.h"
+#include "../par/vec_par.h"
+
+int sync_parallel_map(sync_vec_t * src, sync_vec_t * dst, size_t dst_element_size, vec_map_fn fn, void * ctx) {
+    int res;
+
+    SYNC_VEC_READ_LOCK(src);
+    //dst is not shared with anyone until this returns
+    if ((res = sync_init_with_capacity(dst, dst_element_size, src->used_slots)) == VEC_SUCCESS) {
+        vec_par_map(src->array, src->used_slots, src->element_size, dst->array, dst_element_size, fn, ctx);
+        dst->used_slots = src->used_slots;
+    }
+    SYNC_VEC_UNLOCK(src);
+
+    return res;
+}
+
+int sync_parallel_filter(sync_vec_t * vector, vec_pred_fn pred, void * ctx) {
+    size_t kept;
+    int res;
+
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = vec_par_filter(vector->array, vector->used_slots, vector->element_size, pred, ctx, &kept);
+    if (res == VEC_SUCCESS)
+        res = sync_truncate_locked(vector, kept);
+    SYNC_VEC_UNLOCK(vector);
+
+    return res;
+}
+
+int sync_parallel_reduce(sync_vec_t * vector, void * result, size_t result_size,
+        vec_reduce_fn fn, vec_combine_fn combine, void * ctx) {
+    int res;
+
+    if (result == NULL)
+        return VEC_NULL_BUFFER;
+
+    SYNC_VEC_READ_LOCK(vector);
+    res = vec_par_reduce(vector->array, vector->used_slots, vector->element_size,
+            result, result_size, fn, combine, ctx);
+    SYNC_VEC_UNLOCK(vector);
+
+    return res;
+}
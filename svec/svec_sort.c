@@ -0,0 +1,91 @@
+#include "svec.h"
+#include "../sort/psort.h"
+#include "../sort/radix.h"
+
+//how many times sync_sort_snapshot sorts a copy before giving up and taking the lock
+#define SNAPSHOT_TRIES 3
+
+int sync_parallel_sort_locked(sync_vec_t * vector, cmpfn cmp, int nthreads) {
+    //scratch space comes from the system, the vector's allocator may only hold its array
+    return vec_psort(vector->array, vector->used_slots, vector->element_size, cmp, nthreads, NULL);
+}
+
+int sync_parallel_sort(sync_vec_t * vector, cmpfn cmp, int nthreads) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_parallel_sort_locked(vector, cmp, nthreads);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_radix_sort_locked(sync_vec_t * vector, size_t key_offset, size_t key_width, int flags) {
+    //scratch space comes from the system, like sync_parallel_sort's
+    return vec_radix_sort(vector->array, vector->used_slots, vector->element_size,
+            key_offset, key_width, flags, NULL);
+}
+
+int sync_radix_sort(sync_vec_t * vector, size_t key_offset, size_t key_width, int flags) {
+    int res;
+    SYNC_VEC_WRITE_LOCK(vector);
+    res = sync_radix_sort_locked(vector, key_offset, key_width, flags);
+    SYNC_VEC_UNLOCK(vector);
+    return res;
+}
+
+int sync_sort_snapshot(sync_vec_t * vector, cmpfn cmp, int nthreads) {
+    uint64_t generation;
+    uint32_t used;
+    size_t element_size;
+    void * snapshot, * old;
+    int tries, swap, res;
+
+    for (tries = 0; tries < SNAPSHOT_TRIES; tries++) {
+        SYNC_VEC_READ_LOCK(vector);
+        generation = vector->generation;
+        used = vector->used_slots;
+        element_size = vector->element_size;
+
+        //memory from the system allocator can be handed to the vector as is,
+        //with any other allocator the sorted elements are copied back instead.
+        //A swapped in array needs its unused tail zeroed like the vector keeps it
+        swap = vector->allocator == NULL;
+        if (swap)
+            snapshot = calloc(vector->allocated_slots, element_size);
+        else
+            snapshot = malloc((size_t)used * element_size);
+        if (snapshot != NULL)
+            memcpy(snapshot, vector->array, (size_t)used * element_size);
+        SYNC_VEC_UNLOCK(vector);
+
+        if (snapshot == NULL)
+            return used < 2 ? VEC_SUCCESS : VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+        if ((res = vec_psort(snapshot, used, element_size, cmp, nthreads, NULL))) {
+            free(snapshot);
+            return res;
+        }
+
+        SYNC_VEC_WRITE_LOCK(vector);
+        //taking the write lock bumped the generation once, anything more is another writer
+        if (vector->generation != generation + 1) {
+            SYNC_VEC_UNLOCK(vector);
+            free(snapshot);
+            continue;
+        }
+
+        if (swap) {
+            old = vector->array;
+            vector->array = snapshot;
+            snapshot = old;
+        } else {
+            memcpy(vector->array, snapshot, (size_t)used * element_size);
+        }
+        SYNC_VEC_UNLOCK(vector);
+
+        free(snapshot);
+        return VEC_SUCCESS;
+    }
+
+    //the vector is too busy to ever catch it unchanged
+    return sync_parallel_sort(vector, cmp, nthreads);
+}
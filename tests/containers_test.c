@@ -0,0 +1,376 @@
+/**
+ * checks the other vector types: lf_vec_t with several threads appending, ring_t and
+ * sync_ring_t as they wrap around and grow, seg_vec_t across segment boundaries,
+ * col_vec_t rows against their columns, and the typed and small vectors from tvec.h.
+ *
+ * build: cmake --build <dir> --target containers_test
+ * usage: ./containers_test
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "lfvec.h"
+#include "ring.h"
+#include "sring.h"
+#include "segvec.h"
+#include "colvec.h"
+#include "tvec.h"
+#include "test.h"
+
+VEC_DECLARE(int, intvec)
+VEC_DEFINE(int, intvec)
+
+SMALL_VEC_DECLARE(int, 8, smallints)
+SMALL_VEC_DEFINE(int, 8, smallints)
+
+#define THREADS 4
+#define PER_THREAD 50000
+
+typedef struct {
+    lf_vec_t * vector;
+    uint64_t first;
+} lf_worker_t;
+
+static void * lf_worker(void * arg) {
+    lf_worker_t * w = arg;
+    uint64_t x;
+    int idx;
+
+    for (x = w->first; x < w->first + PER_THREAD; x++)
+        lf_append(w->vector, &x, &idx);
+    return NULL;
+}
+
+static void test_lfvec(void) {
+    lf_vec_t vector;
+    pthread_t threads[THREADS];
+    lf_worker_t workers[THREADS];
+    char * seen;
+    uint64_t x, * array;
+    int i, idx, count, ok;
+
+    memset(&vector, 0, sizeof(lf_vec_t));
+    CHECK_RES(lf_init(&vector, sizeof(uint64_t)), VEC_SUCCESS);
+    CHECK_RES(lf_get(&vector, 0, &x), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(lf_append(&vector, NULL, &idx), VEC_NULL_BUFFER);
+
+    for (i = 0; i < THREADS; i++) {
+        workers[i].vector = &vector;
+        workers[i].first = (uint64_t)i * PER_THREAD;
+        pthread_create(&threads[i], NULL, lf_worker, &workers[i]);
+    }
+    for (i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    //every value landed in exactly one slot
+    CHECK(lf_veclen(&vector) == THREADS * PER_THREAD);
+    seen = calloc(THREADS * PER_THREAD, 1);
+    ok = 1;
+    for (i = 0; i < THREADS * PER_THREAD; i++) {
+        if (lf_get(&vector, i, &x) != VEC_SUCCESS || x >= THREADS * PER_THREAD || seen[x]) {
+            ok = 0;
+            break;
+        }
+        seen[x] = 1;
+    }
+    CHECK(ok);
+    free(seen);
+
+    CHECK_RES(lf_to_array(&vector, (void **)&array, &count), VEC_SUCCESS);
+    CHECK(count == THREADS * PER_THREAD);
+    lf_get(&vector, count - 1, &x);
+    CHECK(array[count - 1] == x);
+    free(array);
+
+    CHECK_RES(lf_destroy(&vector), VEC_SUCCESS);
+    CHECK_RES(lf_destroy(&vector), VEC_ALREADY_DESTROYED);
+}
+
+static void test_ring(void) {
+    ring_t ring;
+    int x, i, ok;
+
+    memset(&ring, 0, sizeof(ring_t));
+    CHECK_RES(ring_init_with_capacity(&ring, sizeof(int), 4), VEC_SUCCESS);
+    CHECK_RES(ring_pop_front(&ring, &x), VEC_NOT_FOUND);
+    CHECK_RES(ring_pop_back(&ring, &x), VEC_NOT_FOUND);
+
+    //wrap the head around the end of the array a few times without growing
+    for (i = 0; i < 100; i++) {
+        CHECK_RES(ring_push_back(&ring, &i), VEC_SUCCESS);
+        CHECK_RES(ring_pop_front(&ring, &x), VEC_SUCCESS);
+        CHECK(x == i);
+    }
+    CHECK(ring_len(&ring) == 0);
+
+    //then grow while wrapped, the logical order has to survive
+    for (i = 0; i < 3; i++)
+        ring_push_back(&ring, &i);
+    for (i = -1; i >= -3; i--)
+        ring_push_front(&ring, &i);
+    for (i = 3; i < 1000; i++)
+        ring_push_back(&ring, &i);
+    CHECK(ring_len(&ring) == 1003);
+    ok = 1;
+    for (i = 0; i < 1003; i++) {
+        ring_get(&ring, i, &x);
+        ok &= x == i - 3;
+    }
+    CHECK(ok);
+    CHECK_RES(ring_get(&ring, 1003, &x), VEC_INDEX_OUT_OF_BOUNDS);
+
+    x = 42;
+    CHECK_RES(ring_replace(&ring, &x, 0), VEC_SUCCESS);
+    CHECK_RES(ring_pop_front(&ring, &x), VEC_SUCCESS);
+    CHECK(x == 42);
+    CHECK_RES(ring_pop_back(&ring, &x), VEC_SUCCESS);
+    CHECK(x == 999);
+
+    for (i = 0; i < 990; i++)
+        ring_pop_front(&ring, NULL);
+    CHECK_RES(ring_shrink_to_fit(&ring), VEC_SUCCESS);
+    CHECK(ring_len(&ring) == 11);
+    ok = 1;
+    for (i = 0; i < 11; i++) {
+        ring_get(&ring, i, &x);
+        ok &= x == 988 + i;
+    }
+    CHECK(ok);
+
+    CHECK_RES(ring_destroy(&ring), VEC_SUCCESS);
+    CHECK_RES(ring_destroy(&ring), VEC_ALREADY_DESTROYED);
+}
+
+typedef struct {
+    sync_ring_t * ring;
+} sring_worker_t;
+
+static void * sring_producer(void * arg) {
+    sring_worker_t * w = arg;
+    int i;
+
+    for (i = 1; i <= PER_THREAD; i++)
+        sync_ring_push_back(w->ring, &i);
+    return NULL;
+}
+
+static void test_sring(void) {
+    sync_ring_t ring;
+    pthread_t threads[THREADS];
+    sring_worker_t workers[THREADS];
+    int64_t sum = 0;
+    int x, i;
+
+    memset(&ring, 0, sizeof(sync_ring_t));
+    CHECK_RES(sync_ring_init(&ring, sizeof(int)), VEC_SUCCESS);
+    for (i = 0; i < THREADS; i++) {
+        workers[i].ring = &ring;
+        pthread_create(&threads[i], NULL, sring_producer, &workers[i]);
+    }
+    for (i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    CHECK(sync_ring_len(&ring) == THREADS * PER_THREAD);
+    while (sync_ring_pop_front(&ring, &x) == VEC_SUCCESS)
+        sum += x;
+    CHECK(sum == (int64_t)THREADS * PER_THREAD * (PER_THREAD + 1) / 2);
+    CHECK_RES(sync_ring_destroy(&ring), VEC_SUCCESS);
+}
+
+static void test_segvec(void) {
+    seg_vec_t vector;
+    uint32_t x, * p, * array, batch[1000];
+    int i, ok;
+
+    memset(&vector, 0, sizeof(seg_vec_t));
+    CHECK_RES(seg_init(&vector, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK_RES(seg_init(&vector, sizeof(uint32_t)), VEC_ALREADY_INITIALIZED);
+
+    //enough to span many segments, half one at a time and half in batches that straddle them
+    for (x = 0; x < 50000; x++)
+        CHECK_RES(seg_append(&vector, &x), VEC_SUCCESS);
+    for (i = 0; i < 50; i++) {
+        for (x = 0; x < 1000; x++)
+            batch[x] = 50000 + i * 1000 + x;
+        CHECK_RES(seg_append_n(&vector, batch, 1000), VEC_SUCCESS);
+    }
+    CHECK(seg_veclen(&vector) == 100000);
+
+    ok = 1;
+    for (i = 0; i < 100000; i++) {
+        seg_get(&vector, i, &x);
+        ok &= x == (uint32_t)i;
+    }
+    CHECK(ok);
+    CHECK_RES(seg_get(&vector, 100000, &x), VEC_INDEX_OUT_OF_BOUNDS);
+
+    //elements never move, so a pointer taken early still sees later writes
+    CHECK_RES(seg_get_ptr(&vector, 5, (void **)&p), VEC_SUCCESS);
+    for (x = 0; x < 100000; x++)
+        seg_append(&vector, &x);
+    x = 77;
+    seg_replace(&vector, &x, 5);
+    CHECK(*p == 77);
+
+    CHECK_RES(seg_truncate(&vector, 10), VEC_SUCCESS);
+    CHECK_RES(seg_shrink_to_fit(&vector), VEC_SUCCESS);
+    CHECK_RES(seg_to_array(&vector, (void **)&array), VEC_SUCCESS);
+    CHECK(array[5] == 77 && array[9] == 9);
+    free(array);
+
+    CHECK_RES(seg_destroy(&vector), VEC_SUCCESS);
+    CHECK_RES(seg_destroy(&vector), VEC_ALREADY_DESTROYED);
+}
+
+typedef struct {
+    uint64_t id;
+    double price;
+    int qty;
+} order_t;
+
+static void test_colvec(void) {
+    col_field_t fields[] = {
+        {offsetof(order_t, id), sizeof(uint64_t)},
+        {offsetof(order_t, price), sizeof(double)},
+        {offsetof(order_t, qty), sizeof(int)},
+    };
+    col_field_t bad[] = {{offsetof(order_t, qty), 16}};
+    col_vec_t vector;
+    order_t o;
+    double * price, total = 0;
+    int * qty;
+    int i, idx = -1, ok;
+
+    memset(&vector, 0, sizeof(col_vec_t));
+    CHECK_RES(col_init(&vector, sizeof(order_t), bad, 1), VEC_INVALID_ARGUMENT);
+    memset(&vector, 0, sizeof(col_vec_t));
+    CHECK_RES(col_init(&vector, sizeof(order_t), fields, 3), VEC_SUCCESS);
+
+    for (i = 0; i < 1000; i++) {
+        memset(&o, 0, sizeof(order_t));
+        o.id = i;
+        o.price = i * 0.5;
+        o.qty = i % 10;
+        CHECK_RES(col_append(&vector, &o), VEC_SUCCESS);
+    }
+    CHECK(col_veclen(&vector) == 1000);
+
+    //rows come back whole, and each column holds its field in row order
+    ok = 1;
+    for (i = 0; i < 1000; i++) {
+        col_get(&vector, i, &o);
+        ok &= o.id == (uint64_t)i && o.price == i * 0.5 && o.qty == i % 10;
+        ok &= *(uint64_t *)COL_VEC_AT(&vector, 0, i) == (uint64_t)i;
+    }
+    CHECK(ok);
+    COL_VEC_SCAN(&vector, 1, price, idx, total += *price);
+    CHECK(total == 0.5 * 999 * 1000 / 2);
+
+    CHECK_RES(COL_VEC_FIND_BY(&vector, 2, qty, idx, *qty == 7), VEC_SUCCESS);
+    CHECK(idx == 7);
+    CHECK_RES(col_remove_index(&vector, 0), VEC_SUCCESS);
+    col_get(&vector, 0, &o);
+    CHECK(o.id == 1 && o.qty == 1);
+
+    CHECK_RES(COL_VEC_FILTER(&vector, 2, qty, *qty != 7), VEC_SUCCESS);
+    CHECK(col_veclen(&vector) == 999 - 100);
+    CHECK_RES(COL_VEC_FIND_BY(&vector, 2, qty, idx, *qty == 7), VEC_NOT_FOUND);
+    ok = 1;
+    for (i = 0; i < col_veclen(&vector); i++) {
+        col_get(&vector, i, &o);
+        ok &= o.qty == (int)(o.id % 10) && o.price == o.id * 0.5;
+    }
+    CHECK(ok);
+
+    CHECK_RES(col_truncate(&vector, 0), VEC_SUCCESS);
+    CHECK_RES(col_get(&vector, 0, &o), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(col_destroy(&vector), VEC_SUCCESS);
+}
+
+static void test_tvec(void) {
+    intvec_t vector;
+    int x = 0, i, ok, batch[3] = {1, 2, 3};
+
+    memset(&vector, 0, sizeof(intvec_t));
+    CHECK_RES(intvec_init(&vector), VEC_SUCCESS);
+    CHECK_RES(intvec_init(&vector), VEC_ALREADY_INITIALIZED);
+    for (i = 0; i < 1000; i++)
+        CHECK_RES(intvec_append(&vector, i), VEC_SUCCESS);
+    CHECK_RES(intvec_insert(&vector, -1, 0), VEC_SUCCESS);
+    CHECK_RES(intvec_remove_index(&vector, 0), VEC_SUCCESS);
+    CHECK_RES(intvec_append_n(&vector, batch, 3), VEC_SUCCESS);
+    CHECK(intvec_veclen(&vector) == 1003);
+    CHECK_RES(intvec_remove_range(&vector, 1000, 3), VEC_SUCCESS);
+    ok = 1;
+    for (i = 0; i < 1000; i++) {
+        intvec_get(&vector, i, &x);
+        ok &= x == i;
+    }
+    CHECK(ok);
+    CHECK_RES(intvec_get(&vector, 1000, &x), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(intvec_destroy(&vector), VEC_SUCCESS);
+    CHECK_RES(intvec_destroy(&vector), VEC_ALREADY_DESTROYED);
+}
+
+static void test_small_vec(void) {
+    smallints_t vector, big;
+    int x = 0, i, ok;
+
+    memset(&vector, 0, sizeof(smallints_t));
+    CHECK_RES(smallints_init(&vector), VEC_SUCCESS);
+    for (i = 0; i < 8; i++)
+        smallints_append(&vector, i);
+    //up to N the elements stay inside the struct
+    CHECK(vector.array == NULL);
+    CHECK(smallints_data(&vector) == vector.inline_slots);
+
+    smallints_append(&vector, 8);
+    CHECK(vector.array != NULL);
+    for (i = 9; i < 100; i++)
+        smallints_append(&vector, i);
+    CHECK_RES(smallints_insert(&vector, -1, 0), VEC_SUCCESS);
+    CHECK_RES(smallints_remove_index(&vector, 0), VEC_SUCCESS);
+    ok = 1;
+    for (i = 0; i < 100; i++) {
+        smallints_get(&vector, i, &x);
+        ok &= x == i;
+    }
+    CHECK(ok);
+
+    //and move back in once they fit again
+    CHECK_RES(smallints_remove_range(&vector, 4, 96), VEC_SUCCESS);
+    CHECK_RES(smallints_shrink_to_fit(&vector), VEC_SUCCESS);
+    CHECK(vector.array == NULL);
+    ok = 1;
+    for (i = 0; i < 4; i++) {
+        smallints_get(&vector, i, &x);
+        ok &= x == i;
+    }
+    CHECK(ok && smallints_veclen(&vector) == 4);
+    CHECK_RES(smallints_destroy(&vector), VEC_SUCCESS);
+
+    memset(&big, 0, sizeof(smallints_t));
+    CHECK_RES(smallints_init_with_capacity(&big, -1), VEC_INVALID_ARGUMENT);
+    CHECK_RES(smallints_init_with_capacity(&big, 4), VEC_SUCCESS);
+    CHECK(big.array == NULL);
+    smallints_destroy(&big);
+    CHECK_RES(smallints_init_with_capacity(&big, 100), VEC_SUCCESS);
+    CHECK(big.array != NULL && big.allocated_slots == 100);
+    for (i = 0; i < 100; i++)
+        smallints_append(&big, i);
+    CHECK(big.allocated_slots == 100);
+    smallints_destroy(&big);
+}
+
+int main(void) {
+    test_lfvec();
+    test_ring();
+    test_sring();
+    test_segvec();
+    test_colvec();
+    test_tvec();
+    test_small_vec();
+    return TEST_DONE();
+}
@@ -0,0 +1,186 @@
+/**
+ * checks sync_vec_t: appends from several threads at once, the sorts against qsort,
+ * sync_merge_sorted, the filtering macros and sync_save/sync_load.
+ *
+ * build: cmake --build <dir> --target svec_test
+ * usage: ./svec_test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "svec.h"
+#include "test.h"
+
+#define THREADS 4
+#define PER_THREAD 20000
+
+typedef struct {
+    sync_vec_t * vector;
+    uint32_t first;
+} worker_t;
+
+static void * append_worker(void * arg) {
+    worker_t * w = arg;
+    uint32_t x;
+
+    for (x = w->first; x < w->first + PER_THREAD; x++)
+        sync_append(w->vector, &x);
+    return NULL;
+}
+
+//fills vector with n random numbers and returns a copy of them
+static uint32_t * fill_random(sync_vec_t * vector, int n, uint64_t seed) {
+    uint32_t * ref = malloc((n > 0 ? n : 1) * sizeof(uint32_t));
+    uint32_t x;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        x = (uint32_t)test_rand(&seed);
+        ref[i] = x;
+        CHECK_RES(sync_append(vector, &x), VEC_SUCCESS);
+    }
+    return ref;
+}
+
+static int matches(sync_vec_t * vector, const void * ref, int n) {
+    return sync_veclen(vector) == n && (n == 0 || memcmp(vector->array, ref, n * vector->element_size) == 0);
+}
+
+static void test_round_trip(void) {
+    sync_vec_t vector;
+    pthread_t threads[THREADS];
+    worker_t workers[THREADS];
+    uint32_t x;
+    int i, ok;
+
+    memset(&vector, 0, sizeof(sync_vec_t));
+    CHECK_RES(sync_init(&vector, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK_RES(sync_init(&vector, sizeof(uint32_t)), VEC_ALREADY_INITIALIZED);
+    CHECK_RES(sync_get(&vector, 0, &x), VEC_INDEX_OUT_OF_BOUNDS);
+
+    for (i = 0; i < THREADS; i++) {
+        workers[i].vector = &vector;
+        workers[i].first = i * PER_THREAD;
+        pthread_create(&threads[i], NULL, append_worker, &workers[i]);
+    }
+    for (i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    //every append landed exactly once
+    CHECK(sync_veclen(&vector) == THREADS * PER_THREAD);
+    CHECK_RES(sync_sort(&vector, test_cmp_u32), VEC_SUCCESS);
+    ok = 1;
+    for (i = 0; i < THREADS * PER_THREAD; i++) {
+        sync_get(&vector, i, &x);
+        ok &= x == (uint32_t)i;
+    }
+    CHECK(ok);
+
+    x = 7;
+    CHECK_RES(sync_insert(&vector, &x, 0), VEC_SUCCESS);
+    CHECK_RES(sync_remove_index(&vector, 0), VEC_SUCCESS);
+    CHECK_RES(sync_truncate(&vector, 100), VEC_SUCCESS);
+    CHECK_RES(SYNC_VEC_FILTER(&vector, &x, x % 2 == 0), VEC_SUCCESS);
+    CHECK(sync_veclen(&vector) == 50);
+    CHECK_RES(SYNC_VEC_ITER_REMOVE(&vector, &x, x >= 50), VEC_SUCCESS);
+    CHECK(sync_veclen(&vector) == 25);
+    ok = 1;
+    for (i = 0; i < 25; i++) {
+        sync_get(&vector, i, &x);
+        ok &= x == (uint32_t)i * 2;
+    }
+    CHECK(ok);
+
+    CHECK_RES(sync_destroy(&vector), VEC_SUCCESS);
+    CHECK_RES(sync_destroy(&vector), VEC_ALREADY_DESTROYED);
+}
+
+static void test_sorts(void) {
+    static const int sizes[] = {0, 1, 1000, 100000};
+    sync_vec_t vector;
+    uint32_t * ref;
+    uint64_t seed;
+    size_t k;
+    int i, n;
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        n = sizes[k];
+
+        memset(&vector, 0, sizeof(sync_vec_t));
+        sync_init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 1 + k);
+        qsort(ref, n, sizeof(uint32_t), test_cmp_u32);
+        CHECK_RES(sync_parallel_sort(&vector, test_cmp_u32, 4), VEC_SUCCESS);
+        CHECK(matches(&vector, ref, n));
+        sync_destroy(&vector);
+        free(ref);
+
+        memset(&vector, 0, sizeof(sync_vec_t));
+        sync_init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 2 + k);
+        qsort(ref, n, sizeof(uint32_t), test_cmp_u32);
+        CHECK_RES(sync_radix_sort(&vector, 0, sizeof(uint32_t), VEC_RADIX_UNSIGNED), VEC_SUCCESS);
+        CHECK(matches(&vector, ref, n));
+        sync_destroy(&vector);
+        free(ref);
+
+        memset(&vector, 0, sizeof(sync_vec_t));
+        sync_init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 3 + k);
+        free(ref);
+        CHECK_RES(SYNC_VEC_SORT_BY(&vector, uint32_t, a, b, *a < *b), VEC_SUCCESS);
+        ref = malloc((2 * n + 1) * sizeof(uint32_t));
+        memcpy(ref, vector.array, n * sizeof(uint32_t));
+        seed = 4 + k;
+        for (i = 0; i < n; i++)
+            ref[n + i] = (uint32_t)test_rand(&seed);
+        CHECK_RES(sync_merge_sorted(&vector, ref + n, n, test_cmp_u32), VEC_SUCCESS);
+        qsort(ref, 2 * n, sizeof(uint32_t), test_cmp_u32);
+        CHECK(matches(&vector, ref, 2 * n));
+        sync_destroy(&vector);
+        free(ref);
+    }
+}
+
+static void test_save_load(void) {
+    int n = 600000;
+    sync_vec_t vector, loaded;
+    uint32_t * ref;
+    FILE * file;
+    int fd;
+
+    memset(&vector, 0, sizeof(sync_vec_t));
+    sync_init(&vector, sizeof(uint32_t));
+    ref = fill_random(&vector, n, 11);
+
+    file = tmpfile();
+    CHECK(file != NULL);
+    if (file == NULL)
+        return;
+    fd = fileno(file);
+    CHECK_RES(sync_save(&vector, fd), VEC_SUCCESS);
+
+    memset(&loaded, 0, sizeof(sync_vec_t));
+    lseek(fd, 0, SEEK_SET);
+    CHECK_RES(sync_load(&loaded, fd), VEC_SUCCESS);
+    CHECK(matches(&loaded, ref, n));
+    sync_destroy(&loaded);
+
+    CHECK(ftruncate(fd, 1000) == 0);
+    lseek(fd, 0, SEEK_SET);
+    memset(&loaded, 0, sizeof(sync_vec_t));
+    CHECK_RES(sync_load(&loaded, fd), VEC_BAD_FORMAT);
+
+    fclose(file);
+    sync_destroy(&vector);
+    free(ref);
+}
+
+int main(void) {
+    test_round_trip();
+    test_sorts();
+    test_save_load();
+    return TEST_DONE();
+}
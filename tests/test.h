@@ -0,0 +1,59 @@
+#ifndef TEST_H
+
+#define TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * a minimal harness for the programs in tests/. CHECK keeps going after a failure
+ * so one run reports everything that is broken, and TEST_DONE makes the exit status
+ * tell ctest whether anything failed. Unlike assert it is not compiled out by NDEBUG,
+ * which the Release build sets.
+ */
+static int test_failures = 0;
+
+#define CHECK(condition) do {\
+        if (!(condition)) {\
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);\
+            test_failures++;\
+        }\
+} while (0)
+
+//checks that call returns expected, for the functions returning VEC_* codes
+#define CHECK_RES(call, expected) do {\
+        int _res = (call);\
+        if (_res != (expected)) {\
+            fprintf(stderr, "%s:%d: %s returned %d, expected %d\n", __FILE__, __LINE__, #call, _res, (int)(expected));\
+            test_failures++;\
+        }\
+} while (0)
+
+#define TEST_DONE() ({\
+        if (test_failures)\
+            fprintf(stderr, "%d checks failed\n", test_failures);\
+        test_failures ? EXIT_FAILURE : EXIT_SUCCESS;\
+})
+
+/**
+ * a deterministic xorshift generator, so a failure reproduces on the next run
+ */
+static inline uint64_t test_rand(uint64_t * state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static inline int test_cmp_u32(const void * a, const void * b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static inline int test_cmp_i64(const void * a, const void * b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+#endif
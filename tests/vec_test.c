@@ -0,0 +1,430 @@
+/**
+ * checks vec_t: element round trips and the edge cases of the basic functions, every
+ * sort against qsort, the hash index after each kind of change, vec_save/vec_load,
+ * and file backed vectors across a reopen, including sorting them in place.
+ *
+ * build: cmake --build <dir> --target vec_test
+ * usage: ./vec_test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "vec.h"
+#include "test.h"
+
+typedef struct {
+    uint32_t key;
+    uint32_t value;
+} pair_t;
+
+static int cmp_pair(const void * a, const void * b) {
+    return test_cmp_u32(&((const pair_t *)a)->key, &((const pair_t *)b)->key);
+}
+
+//fills vector with n random numbers and returns a copy of them
+static uint32_t * fill_random(vec_t * vector, int n, uint64_t seed) {
+    uint32_t * ref = malloc((n > 0 ? n : 1) * sizeof(uint32_t));
+    uint32_t x;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        x = (uint32_t)test_rand(&seed);
+        ref[i] = x;
+        CHECK_RES(append(vector, &x), VEC_SUCCESS);
+    }
+    return ref;
+}
+
+static int matches(vec_t * vector, const void * ref, int n) {
+    return veclen(vector) == n && (n == 0 || memcmp(vec_data(vector), ref, n * vector->element_size) == 0);
+}
+
+static void test_round_trip(void) {
+    vec_t vector, other;
+    uint64_t x, y;
+    void * array;
+    int i, idx;
+
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(init(&vector, sizeof(uint64_t)), VEC_SUCCESS);
+    CHECK_RES(init(&vector, sizeof(uint64_t)), VEC_ALREADY_INITIALIZED);
+    CHECK_RES(get(&vector, 0, &x), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(remove_index(&vector, 0), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(append(&vector, NULL), VEC_NULL_BUFFER);
+
+    for (x = 0; x < 1000; x++)
+        CHECK_RES(append(&vector, &x), VEC_SUCCESS);
+    CHECK(veclen(&vector) == 1000);
+    for (i = 0; i < 1000; i++) {
+        CHECK_RES(get(&vector, i, &y), VEC_SUCCESS);
+        CHECK(y == (uint64_t)i);
+    }
+    CHECK_RES(get(&vector, 1000, &y), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(get(&vector, -1, &y), VEC_INDEX_OUT_OF_BOUNDS);
+
+    //insert at both ends and in the middle, then take them out again
+    x = 5000;
+    CHECK_RES(insert(&vector, &x, 0), VEC_SUCCESS);
+    CHECK_RES(insert(&vector, &x, 500), VEC_SUCCESS);
+    CHECK_RES(insert(&vector, &x, veclen(&vector)), VEC_SUCCESS);
+    CHECK_RES(insert(&vector, &x, veclen(&vector) + 1), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(remove_index(&vector, veclen(&vector) - 1), VEC_SUCCESS);
+    CHECK_RES(remove_index(&vector, 500), VEC_SUCCESS);
+    CHECK_RES(remove_element(&vector, &x), VEC_SUCCESS);
+    CHECK_RES(remove_element(&vector, &x), VEC_NOT_FOUND);
+    for (i = 0; i < 1000; i++) {
+        get(&vector, i, &y);
+        CHECK(y == (uint64_t)i);
+    }
+
+    //swap_remove moves the last element into the hole
+    CHECK_RES(swap_remove(&vector, 10), VEC_SUCCESS);
+    get(&vector, 10, &y);
+    CHECK(y == 999);
+    CHECK(veclen(&vector) == 999);
+
+    CHECK_RES(remove_range(&vector, 0, 100), VEC_SUCCESS);
+    get(&vector, 0, &y);
+    CHECK(y == 100);
+    CHECK_RES(remove_range(&vector, 0, veclen(&vector) + 1), VEC_INDEX_OUT_OF_BOUNDS);
+    CHECK_RES(vec_truncate(&vector, 10), VEC_SUCCESS);
+    CHECK(veclen(&vector) == 10);
+
+    CHECK_RES(vec_find(&vector, &y, &idx), VEC_SUCCESS);
+    CHECK(idx == 0);
+    CHECK_RES(vec_find_key(&vector, &y, &idx), VEC_INVALID_ARGUMENT);
+
+    memset(&other, 0, sizeof(vec_t));
+    CHECK_RES(copy(&vector, &other), VEC_SUCCESS);
+    CHECK(matches(&other, vec_data(&vector), veclen(&vector)));
+    CHECK_RES(to_array(&vector, &array), VEC_SUCCESS);
+    CHECK(memcmp(array, vec_data(&vector), 10 * sizeof(uint64_t)) == 0);
+    free(array);
+
+    CHECK_RES(vec_truncate(&vector, 0), VEC_SUCCESS);
+    CHECK(veclen(&vector) == 0);
+    CHECK_RES(append(&vector, &x), VEC_SUCCESS);
+    CHECK(veclen(&vector) == 1);
+
+    CHECK_RES(destroy(&other), VEC_SUCCESS);
+    CHECK_RES(destroy(&vector), VEC_SUCCESS);
+    CHECK_RES(destroy(&vector), VEC_ALREADY_DESTROYED);
+
+    CHECK_RES(init_with_capacity(&vector, sizeof(uint64_t), -1), VEC_INVALID_ARGUMENT);
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(init_with_capacity(&vector, sizeof(uint64_t), 100), VEC_SUCCESS);
+    CHECK(vector.allocated_slots >= 100);
+    destroy(&vector);
+}
+
+static void test_sorts(void) {
+    static const int sizes[] = {0, 1, 2, 1000, 100000};
+    vec_t vector;
+    uint32_t * ref;
+    int64_t * signed_ref;
+    int64_t y;
+    pair_t p;
+    uint64_t seed;
+    size_t k;
+    int i, n, ok;
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        n = sizes[k];
+
+        memset(&vector, 0, sizeof(vec_t));
+        init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 1 + k);
+        qsort(ref, n, sizeof(uint32_t), test_cmp_u32);
+        CHECK_RES(sort(&vector, test_cmp_u32), VEC_SUCCESS);
+        CHECK(matches(&vector, ref, n));
+        destroy(&vector);
+        free(ref);
+
+        memset(&vector, 0, sizeof(vec_t));
+        init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 2 + k);
+        qsort(ref, n, sizeof(uint32_t), test_cmp_u32);
+        CHECK_RES(parallel_sort(&vector, test_cmp_u32, 4), VEC_SUCCESS);
+        CHECK(matches(&vector, ref, n));
+        destroy(&vector);
+        free(ref);
+
+        memset(&vector, 0, sizeof(vec_t));
+        init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 3 + k);
+        qsort(ref, n, sizeof(uint32_t), test_cmp_u32);
+        CHECK_RES(radix_sort(&vector, 0, sizeof(uint32_t), VEC_RADIX_UNSIGNED), VEC_SUCCESS);
+        CHECK(matches(&vector, ref, n));
+        destroy(&vector);
+        free(ref);
+
+        //signed keys have to put the negative ones first
+        memset(&vector, 0, sizeof(vec_t));
+        init(&vector, sizeof(int64_t));
+        signed_ref = malloc((n > 0 ? n : 1) * sizeof(int64_t));
+        seed = 4 + k;
+        for (i = 0; i < n; i++) {
+            y = (int64_t)test_rand(&seed);
+            signed_ref[i] = y;
+            append(&vector, &y);
+        }
+        qsort(signed_ref, n, sizeof(int64_t), test_cmp_i64);
+        CHECK_RES(radix_sort(&vector, 0, sizeof(int64_t), VEC_RADIX_SIGNED), VEC_SUCCESS);
+        CHECK(matches(&vector, signed_ref, n));
+        destroy(&vector);
+        free(signed_ref);
+
+        //VEC_SORT_BY on a key inside the element; equal keys may land in any order
+        memset(&vector, 0, sizeof(vec_t));
+        init(&vector, sizeof(pair_t));
+        seed = 5 + k;
+        for (i = 0; i < n; i++) {
+            p.key = test_rand(&seed) % 1000;
+            p.value = i;
+            append(&vector, &p);
+        }
+        CHECK_RES(VEC_SORT_BY(&vector, pair_t, a, b, a->key < b->key), VEC_SUCCESS);
+        CHECK(veclen(&vector) == n);
+        ok = 1;
+        for (i = 1; i < n; i++)
+            ok &= ((pair_t *)vec_data(&vector))[i - 1].key <= ((pair_t *)vec_data(&vector))[i].key;
+        CHECK(ok);
+        CHECK_RES(VEC_SORT_BY(&vector, uint32_t, a, b, *a < *b), VEC_INVALID_ARGUMENT);
+        destroy(&vector);
+
+        //merge_sorted against sorting everything at once
+        memset(&vector, 0, sizeof(vec_t));
+        init(&vector, sizeof(uint32_t));
+        ref = fill_random(&vector, n, 6 + k);
+        free(ref);
+        sort(&vector, test_cmp_u32);
+        ref = malloc((2 * n + 1) * sizeof(uint32_t));
+        memcpy(ref, vec_data(&vector), n * sizeof(uint32_t));
+        seed = 7 + k;
+        for (i = 0; i < n; i++)
+            ref[n + i] = (uint32_t)test_rand(&seed);
+        CHECK_RES(merge_sorted(&vector, ref + n, n, test_cmp_u32), VEC_SUCCESS);
+        qsort(ref, 2 * n, sizeof(uint32_t), test_cmp_u32);
+        CHECK(matches(&vector, ref, 2 * n));
+        CHECK_RES(merge_sorted(&vector, ref, -1, test_cmp_u32), VEC_INDEX_OUT_OF_BOUNDS);
+        destroy(&vector);
+        free(ref);
+    }
+}
+
+//every element must be found at its own position, by key and whole
+static int index_consistent(vec_t * vector) {
+    pair_t * data = vec_data(vector);
+    int i, idx;
+
+    for (i = 0; i < veclen(vector); i++) {
+        if (vec_find_key(vector, &data[i].key, &idx) != VEC_SUCCESS || idx != i)
+            return 0;
+        if (vec_find(vector, &data[i], &idx) != VEC_SUCCESS || idx != i)
+            return 0;
+    }
+    return 1;
+}
+
+static void test_index(void) {
+    vec_t vector;
+    pair_t p, batch[100];
+    uint32_t key;
+    int i, idx;
+
+    memset(&vector, 0, sizeof(vec_t));
+    init(&vector, sizeof(pair_t));
+    CHECK_RES(vec_index_enable(&vector, 0, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK_RES(vec_index_enable(&vector, 0, sizeof(uint32_t)), VEC_ALREADY_INITIALIZED);
+
+    //unique keys, so each one has exactly one position
+    for (i = 0; i < 2000; i++) {
+        p.key = i * 7919u;
+        p.value = i;
+        append(&vector, &p);
+    }
+    CHECK(index_consistent(&vector));
+
+    p.key = 1;
+    p.value = 0;
+    CHECK_RES(insert(&vector, &p, 0), VEC_SUCCESS);
+    p.key = 3;
+    CHECK_RES(insert(&vector, &p, 1000), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+
+    CHECK_RES(remove_index(&vector, 500), VEC_SUCCESS);
+    CHECK_RES(swap_remove(&vector, 10), VEC_SUCCESS);
+    CHECK_RES(remove_range(&vector, 100, 50), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+
+    //the key alone finds it, the whole element only with the same value
+    p.key = 3;
+    p.value = 0;
+    CHECK_RES(vec_find_key(&vector, &p.key, &idx), VEC_SUCCESS);
+    CHECK_RES(vec_find(&vector, &p, &idx), VEC_SUCCESS);
+    p.value = 1;
+    CHECK_RES(vec_find(&vector, &p, &idx), VEC_NOT_FOUND);
+    CHECK_RES(remove_element(&vector, &p), VEC_NOT_FOUND);
+    p.value = 0;
+    CHECK_RES(remove_element(&vector, &p), VEC_SUCCESS);
+    CHECK_RES(vec_find_key(&vector, &p.key, &idx), VEC_NOT_FOUND);
+    CHECK(index_consistent(&vector));
+
+    p.key = 11;
+    CHECK_RES(replace(&vector, &p, 20), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+
+    //the single pass compactions move everything behind the first removed element
+    CHECK_RES(VEC_FILTER(&vector, &p, p.value % 3 != 0), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+    CHECK_RES(VEC_ITER_REMOVE(&vector, &p, p.value % 5 == 0), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+    CHECK_RES(VEC_ITER(&vector, &p, p.key += 1), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+
+    CHECK_RES(sort(&vector, cmp_pair), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+    for (i = 0; i < 100; i++) {
+        batch[i].key = 2 + 7919u * i * 2;
+        batch[i].value = i;
+    }
+    CHECK_RES(merge_sorted(&vector, batch, 100, cmp_pair), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+    CHECK_RES(VEC_SORT_BY(&vector, pair_t, a, b, a->value < b->value), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+    CHECK_RES(vec_truncate(&vector, 10), VEC_SUCCESS);
+    CHECK(index_consistent(&vector));
+
+    CHECK_RES(vec_index_disable(&vector), VEC_SUCCESS);
+    CHECK_RES(vec_index_disable(&vector), VEC_NOT_FOUND);
+    key = 0;
+    CHECK_RES(vec_find_key(&vector, &key, &idx), VEC_INVALID_ARGUMENT);
+    destroy(&vector);
+}
+
+static void test_save_load(void) {
+    //large enough for several chunks of the stream format
+    int n = 600000;
+    vec_t vector, loaded;
+    uint32_t * ref;
+    FILE * file;
+    int fd;
+
+    memset(&vector, 0, sizeof(vec_t));
+    init(&vector, sizeof(uint32_t));
+    ref = fill_random(&vector, n, 11);
+
+    file = tmpfile();
+    CHECK(file != NULL);
+    if (file == NULL)
+        return;
+    fd = fileno(file);
+    CHECK_RES(vec_save(&vector, fd), VEC_SUCCESS);
+
+    memset(&loaded, 0, sizeof(vec_t));
+    lseek(fd, 0, SEEK_SET);
+    CHECK_RES(vec_load(&loaded, fd), VEC_SUCCESS);
+    CHECK(loaded.element_size == sizeof(uint32_t));
+    CHECK(matches(&loaded, ref, n));
+    destroy(&loaded);
+
+    //a cut off stream is refused and leaves nothing behind
+    CHECK(ftruncate(fd, 1000) == 0);
+    lseek(fd, 0, SEEK_SET);
+    memset(&loaded, 0, sizeof(vec_t));
+    CHECK_RES(vec_load(&loaded, fd), VEC_BAD_FORMAT);
+    CHECK(loaded.array == NULL);
+
+    //and so is an empty one, while an empty vector round trips
+    CHECK(ftruncate(fd, 0) == 0);
+    lseek(fd, 0, SEEK_SET);
+    CHECK_RES(vec_load(&loaded, fd), VEC_BAD_FORMAT);
+    vec_truncate(&vector, 0);
+    CHECK_RES(vec_save(&vector, fd), VEC_SUCCESS);
+    lseek(fd, 0, SEEK_SET);
+    memset(&loaded, 0, sizeof(vec_t));
+    CHECK_RES(vec_load(&loaded, fd), VEC_SUCCESS);
+    CHECK(veclen(&loaded) == 0);
+    destroy(&loaded);
+
+    fclose(file);
+    destroy(&vector);
+    free(ref);
+}
+
+static void test_mmap(void) {
+    int n = 200000;
+    char path[] = "/tmp/vec_test_XXXXXX";
+    vec_t vector;
+    uint32_t * ref, * batch;
+    uint64_t seed = 21;
+    int fd, i;
+
+    fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0)
+        return;
+    close(fd);
+    unlink(path);
+
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(vec_open_mmap(&vector, path, sizeof(uint32_t)), VEC_SUCCESS);
+    ref = fill_random(&vector, n, 20);
+    CHECK_RES(vec_close_mmap(&vector), VEC_SUCCESS);
+
+    CHECK_RES(vec_open_mmap(&vector, path, sizeof(uint64_t)), VEC_BAD_FORMAT);
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(vec_open_mmap(&vector, path, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK(matches(&vector, ref, n));
+
+    //the sorts take their scratch space from the system, the file only holds the array
+    qsort(ref, n, sizeof(uint32_t), test_cmp_u32);
+    CHECK_RES(parallel_sort(&vector, test_cmp_u32, 4), VEC_SUCCESS);
+    CHECK(matches(&vector, ref, n));
+    CHECK_RES(vec_close_mmap(&vector), VEC_SUCCESS);
+
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(vec_open_mmap(&vector, path, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK(matches(&vector, ref, n));
+    for (i = 0; i < n / 2; i++) {
+        uint32_t t = ((uint32_t *)vec_data(&vector))[i];
+        ((uint32_t *)vec_data(&vector))[i] = ((uint32_t *)vec_data(&vector))[n - 1 - i];
+        ((uint32_t *)vec_data(&vector))[n - 1 - i] = t;
+    }
+    CHECK_RES(radix_sort(&vector, 0, sizeof(uint32_t), VEC_RADIX_UNSIGNED), VEC_SUCCESS);
+    CHECK(matches(&vector, ref, n));
+
+    batch = malloc(n * sizeof(uint32_t));
+    ref = realloc(ref, 2 * n * sizeof(uint32_t));
+    for (i = 0; i < n; i++)
+        ref[n + i] = batch[i] = (uint32_t)test_rand(&seed);
+    CHECK_RES(merge_sorted(&vector, batch, n, test_cmp_u32), VEC_SUCCESS);
+    qsort(ref, 2 * n, sizeof(uint32_t), test_cmp_u32);
+    CHECK(matches(&vector, ref, 2 * n));
+    CHECK_RES(vec_close_mmap(&vector), VEC_SUCCESS);
+
+    //shrinking shrinks the file, and the length survives the reopen
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(vec_open_mmap(&vector, path, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK(matches(&vector, ref, 2 * n));
+    CHECK_RES(vec_truncate(&vector, 10), VEC_SUCCESS);
+    CHECK_RES(vec_close_mmap(&vector), VEC_SUCCESS);
+    memset(&vector, 0, sizeof(vec_t));
+    CHECK_RES(vec_open_mmap(&vector, path, sizeof(uint32_t)), VEC_SUCCESS);
+    CHECK(matches(&vector, ref, 10));
+    CHECK_RES(vec_close_mmap(&vector), VEC_SUCCESS);
+
+    unlink(path);
+    free(batch);
+    free(ref);
+}
+
+int main(void) {
+    test_round_trip();
+    test_sorts();
+    test_index();
+    test_save_load();
+    test_mmap();
+    return TEST_DONE();
+}
@@ -0,0 +1,523 @@
+#ifndef TVEC_H
+
+#define TVEC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vec_errors.h"
+
+#define TVEC_MIN_SIZE 64
+
+/**
+ * Type specialized vectors.  Where vec_t stores the element size at runtime and
+ * copies everything through void *, these know the element type at compile time,
+ * so every copy is a plain assignment the compiler can turn into register moves.
+ *
+ * VEC_DECLARE(T, name) goes in a header. It declares the name_t struct and
+ * the name_* functions, and defines the hot ones (append, get, get_ptr, replace,
+ * veclen) as static inline so the common case never leaves the caller.
+ * VEC_DEFINE(T, name) goes in exactly one .c file and defines the rest.
+ *
+ * T must be a single identifier or a type that can be written after "T *",
+ * so use a typedef for things like unsigned long or struct x.
+ *
+ * Example:
+ *      VEC_DECLARE(int, intvec)
+ *      VEC_DEFINE(int, intvec)
+ *
+ *      intvec_t vector;
+ *      int x;
+ *      memset(&vector, 0, sizeof(intvec_t));
+ *      intvec_init(&vector);
+ *      intvec_append(&vector, 5);
+ *      intvec_get(&vector, 0, &x);
+ *      intvec_destroy(&vector);
+ *
+ * The generated functions behave like their vec.h counterparts and return the same
+ * error codes, except that elements are passed by value instead of through a pointer:
+ *
+ *  int name_init(name_t * vector);
+ *  int name_init_with_capacity(name_t * vector, int capacity);
+ *  int name_append(name_t * vector, T element);
+ *  int name_append_n(name_t * vector, const T * elements, int count);
+ *  int name_insert(name_t * vector, T element, int idx);
+ *  int name_replace(name_t * vector, T element, int idx);
+ *  int name_veclen(name_t * vector);
+ *  int name_remove_index(name_t * vector, int idx);
+ *  int name_remove_range(name_t * vector, int idx, int count);
+ *  int name_get(name_t * vector, int idx, T * element_buffer);
+ *  int name_get_ptr(name_t * vector, int idx, T ** element_ptr);
+ *  int name_reserve(name_t * vector, int capacity);
+ *  int name_sort(name_t * vector, int (*cmp)(const void *, const void *));
+ *  int name_destroy(name_t * vector);
+ */
+#define VEC_DECLARE(T, name) \
+typedef struct { \
+    uint32_t allocated_slots; \
+    uint32_t used_slots; \
+    T * array; \
+} name##_t; \
+\
+int name##_init(name##_t * vector); \
+int name##_init_with_capacity(name##_t * vector, int capacity); \
+int name##_grow(name##_t * vector, uint32_t needed); \
+int name##_append_n(name##_t * vector, const T * elements, int count); \
+int name##_insert(name##_t * vector, T element, int idx); \
+int name##_remove_index(name##_t * vector, int idx); \
+int name##_remove_range(name##_t * vector, int idx, int count); \
+int name##_reserve(name##_t * vector, int capacity); \
+int name##_sort(name##_t * vector, int (*cmp)(const void *, const void *)); \
+int name##_destroy(name##_t * vector); \
+\
+static inline int name##_append(name##_t * vector, T element) { \
+    /* only leave the fast path when the vector is full */ \
+    if (vector->used_slots == vector->allocated_slots) { \
+        if (name##_grow(vector, vector->used_slots + 1)) \
+            return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    } \
+    vector->array[vector->used_slots++] = element; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_get(name##_t * vector, int idx, T * element_buffer) { \
+    if (element_buffer == NULL) \
+        return VEC_NULL_BUFFER; \
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    *element_buffer = vector->array[idx]; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_get_ptr(name##_t * vector, int idx, T ** element_ptr) { \
+    if (element_ptr == NULL) \
+        return VEC_NULL_BUFFER; \
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    *element_ptr = &vector->array[idx]; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_replace(name##_t * vector, T element, int idx) { \
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    vector->array[idx] = element; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_veclen(name##_t * vector) { \
+    return vector->used_slots; \
+}
+
+#define VEC_DEFINE(T, name) \
+static int name##_resize(name##_t * vector, uint32_t new_slots) { \
+    T * tmp = realloc(vector->array, (size_t)new_slots * sizeof(T)); \
+    if (tmp == NULL) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    vector->array = tmp; \
+    vector->allocated_slots = new_slots; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_grow(name##_t * vector, uint32_t needed) { \
+    uint32_t new_slots = vector->allocated_slots; \
+    if (needed <= vector->allocated_slots) \
+        return VEC_SUCCESS; \
+    /* keep doubling until it fits so a bulk insert only reallocs once */ \
+    while (new_slots < needed) { \
+        if (new_slots == 0) \
+            new_slots = TVEC_MIN_SIZE; \
+        else if (new_slots > UINT32_MAX / 2) \
+            new_slots = needed; \
+        else \
+            new_slots *= 2; \
+    } \
+    return name##_resize(vector, new_slots); \
+} \
+\
+int name##_init(name##_t * vector) { \
+    return name##_init_with_capacity(vector, TVEC_MIN_SIZE); \
+} \
+\
+int name##_init_with_capacity(name##_t * vector, int capacity) { \
+    if (vector->array != NULL && vector->allocated_slots > 0) \
+        return VEC_ALREADY_INITIALIZED; \
+    if (capacity < 0) \
+        return VEC_INVALID_ARGUMENT; \
+    if (capacity == 0) \
+        capacity = 1; \
+    vector->used_slots = 0; \
+    vector->allocated_slots = capacity; \
+    vector->array = calloc(capacity, sizeof(T)); \
+    if (vector->array == NULL) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_append_n(name##_t * vector, const T * elements, int count) { \
+    if (count < 0) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    if (count == 0) \
+        return VEC_SUCCESS; \
+    if (elements == NULL) \
+        return VEC_NULL_BUFFER; \
+    if ((uint32_t)count > UINT32_MAX - vector->used_slots) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    if (name##_grow(vector, vector->used_slots + count)) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    memcpy(vector->array + vector->used_slots, elements, count * sizeof(T)); \
+    vector->used_slots += count; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_insert(name##_t * vector, T element, int idx) { \
+    if (!(idx >= 0 && (uint32_t)idx <= vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    if (name##_grow(vector, vector->used_slots + 1)) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    memmove(vector->array + idx + 1, vector->array + idx, \
+            (vector->used_slots - idx) * sizeof(T)); \
+    vector->array[idx] = element; \
+    vector->used_slots++; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_remove_index(name##_t * vector, int idx) { \
+    return name##_remove_range(vector, idx, 1); \
+} \
+\
+int name##_remove_range(name##_t * vector, int idx, int count) { \
+    uint32_t new_slots; \
+    if (!(idx >= 0 && count >= 0 && (size_t)idx + count <= vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    if (count == 0) \
+        return VEC_SUCCESS; \
+    memmove(vector->array + idx, vector->array + idx + count, \
+            (vector->used_slots - idx - count) * sizeof(T)); \
+    vector->used_slots -= count; \
+    memset(vector->array + vector->used_slots, 0, count * sizeof(T)); \
+    /* shrink if now use 1/4 space as allocated, keeping room to grow again */ \
+    if (vector->used_slots < vector->allocated_slots / 4 && vector->allocated_slots > TVEC_MIN_SIZE) { \
+        new_slots = vector->used_slots * 2; \
+        if (new_slots < TVEC_MIN_SIZE) \
+            new_slots = TVEC_MIN_SIZE; \
+        if (name##_resize(vector, new_slots)) \
+            return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    } \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_reserve(name##_t * vector, int capacity) { \
+    if (capacity < 0) \
+        return VEC_INVALID_ARGUMENT; \
+    if ((uint32_t)capacity <= vector->allocated_slots) \
+        return VEC_SUCCESS; \
+    return name##_resize(vector, capacity); \
+} \
+\
+int name##_sort(name##_t * vector, int (*cmp)(const void *, const void *)) { \
+    qsort(vector->array, vector->used_slots, sizeof(T), cmp); \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_destroy(name##_t * vector) { \
+    if (vector->array == NULL) \
+        return VEC_ALREADY_DESTROYED; \
+    free(vector->array); \
+    memset(vector, 0, sizeof(name##_t)); \
+    return VEC_SUCCESS; \
+}
+
+/**
+ * Allows you to iterate through a typed vector in place.
+ * vector is a name_t *, element_ptr is a T * variable that is pointed at each
+ * element in turn.  break will work to end early.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define TVEC_ITER(vector, element_ptr, expression) ({\
+        int _ret = VEC_SUCCESS;\
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            element_ptr = &(vector)->array[_i];\
+            expression;\
+        }\
+        _ret;\
+})
+
+/**
+ * finds the element in a typed vector based on the given condition.
+ * element_ptr is a T * variable, left pointing at the found element on success.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ */
+#define TVEC_FIND_BY(vector, element_ptr, condition) ({\
+        int _ret = VEC_NOT_FOUND; \
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) { \
+            element_ptr = &(vector)->array[_i]; \
+            if (condition) { \
+                _ret = VEC_SUCCESS; \
+                break; \
+            } \
+        } \
+        _ret; \
+})
+
+/**
+ * Small vectors.  Same as VEC_DECLARE/VEC_DEFINE, but the first N elements live
+ * inside the name_t struct itself, so a vector that never holds more than N
+ * elements never touches the heap.  Once it outgrows that it moves to a heap
+ * array and behaves like a normal typed vector; name_shrink_to_fit moves it
+ * back inside the struct if it fits again.
+ *
+ * The functions are the same as for VEC_DECLARE, plus the ones below.
+ * name_init_with_capacity keeps the elements inside the struct when capacity
+ * is N or less, and starts on the heap otherwise.
+ *
+ *  T * name_data(name_t * vector);            the elements, wherever they currently live
+ *  int name_shrink_to_fit(name_t * vector);
+ *
+ * Because the elements may live inside the struct, pointers into the vector
+ * are invalidated by moving or copying the struct, not just by growing it.
+ *
+ * Example:
+ *      SMALL_VEC_DECLARE(int, 8, smallints)
+ *      SMALL_VEC_DEFINE(int, 8, smallints)
+ */
+#define SMALL_VEC_DECLARE(T, N, name) \
+typedef struct { \
+    uint32_t allocated_slots; \
+    uint32_t used_slots; \
+    T * array; \
+    T inline_slots[N]; \
+} name##_t; \
+\
+int name##_init(name##_t * vector); \
+int name##_init_with_capacity(name##_t * vector, int capacity); \
+int name##_grow(name##_t * vector, uint32_t needed); \
+int name##_append_n(name##_t * vector, const T * elements, int count); \
+int name##_insert(name##_t * vector, T element, int idx); \
+int name##_remove_index(name##_t * vector, int idx); \
+int name##_remove_range(name##_t * vector, int idx, int count); \
+int name##_reserve(name##_t * vector, int capacity); \
+int name##_shrink_to_fit(name##_t * vector); \
+int name##_sort(name##_t * vector, int (*cmp)(const void *, const void *)); \
+int name##_destroy(name##_t * vector); \
+\
+static inline T * name##_data(name##_t * vector) { \
+    return vector->array != NULL ? vector->array : vector->inline_slots; \
+} \
+\
+static inline int name##_append(name##_t * vector, T element) { \
+    /* only leave the fast path when the vector is full */ \
+    if (vector->used_slots == vector->allocated_slots) { \
+        if (name##_grow(vector, vector->used_slots + 1)) \
+            return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    } \
+    name##_data(vector)[vector->used_slots++] = element; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_get(name##_t * vector, int idx, T * element_buffer) { \
+    if (element_buffer == NULL) \
+        return VEC_NULL_BUFFER; \
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    *element_buffer = name##_data(vector)[idx]; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_get_ptr(name##_t * vector, int idx, T ** element_ptr) { \
+    if (element_ptr == NULL) \
+        return VEC_NULL_BUFFER; \
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    *element_ptr = &name##_data(vector)[idx]; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_replace(name##_t * vector, T element, int idx) { \
+    if (!(idx >= 0 && (uint32_t)idx < vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    name##_data(vector)[idx] = element; \
+    return VEC_SUCCESS; \
+} \
+\
+static inline int name##_veclen(name##_t * vector) { \
+    return vector->used_slots; \
+}
+
+#define SMALL_VEC_DEFINE(T, N, name) \
+static int name##_resize(name##_t * vector, uint32_t new_slots) { \
+    T * tmp; \
+    /* fits inside the struct again, move back and drop the heap array */ \
+    if (new_slots <= (N)) { \
+        if (vector->array != NULL) { \
+            memcpy(vector->inline_slots, vector->array, vector->used_slots * sizeof(T)); \
+            free(vector->array); \
+            vector->array = NULL; \
+        } \
+        vector->allocated_slots = (N); \
+        return VEC_SUCCESS; \
+    } \
+    /* spilling out of the struct for the first time */ \
+    if (vector->array == NULL) { \
+        tmp = malloc((size_t)new_slots * sizeof(T)); \
+        if (tmp == NULL) \
+            return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+        memcpy(tmp, vector->inline_slots, vector->used_slots * sizeof(T)); \
+    } \
+    else { \
+        tmp = realloc(vector->array, (size_t)new_slots * sizeof(T)); \
+        if (tmp == NULL) \
+            return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    } \
+    vector->array = tmp; \
+    vector->allocated_slots = new_slots; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_grow(name##_t * vector, uint32_t needed) { \
+    uint32_t new_slots = vector->allocated_slots; \
+    if (needed <= vector->allocated_slots) \
+        return VEC_SUCCESS; \
+    /* keep doubling until it fits so a bulk insert only reallocs once */ \
+    while (new_slots < needed) { \
+        if (new_slots == 0) \
+            new_slots = (N) > 0 ? (N) : 1; \
+        else if (new_slots > UINT32_MAX / 2) \
+            new_slots = needed; \
+        else \
+            new_slots *= 2; \
+    } \
+    return name##_resize(vector, new_slots); \
+} \
+\
+int name##_init(name##_t * vector) { \
+    if (vector->allocated_slots > 0) \
+        return VEC_ALREADY_INITIALIZED; \
+    vector->used_slots = 0; \
+    vector->allocated_slots = (N); \
+    vector->array = NULL; \
+    memset(vector->inline_slots, 0, sizeof(vector->inline_slots)); \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_init_with_capacity(name##_t * vector, int capacity) { \
+    int res; \
+    if (vector->allocated_slots > 0) \
+        return VEC_ALREADY_INITIALIZED; \
+    if (capacity < 0) \
+        return VEC_INVALID_ARGUMENT; \
+    if ((res = name##_init(vector))) \
+        return res; \
+    /* more than fits inside the struct goes straight to the heap */ \
+    if ((uint32_t)capacity > (N) && name##_resize(vector, capacity)) { \
+        memset(vector, 0, sizeof(name##_t)); \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    } \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_append_n(name##_t * vector, const T * elements, int count) { \
+    if (count < 0) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    if (count == 0) \
+        return VEC_SUCCESS; \
+    if (elements == NULL) \
+        return VEC_NULL_BUFFER; \
+    if ((uint32_t)count > UINT32_MAX - vector->used_slots) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    if (name##_grow(vector, vector->used_slots + count)) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    memcpy(name##_data(vector) + vector->used_slots, elements, count * sizeof(T)); \
+    vector->used_slots += count; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_insert(name##_t * vector, T element, int idx) { \
+    T * data; \
+    if (!(idx >= 0 && (uint32_t)idx <= vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    if (name##_grow(vector, vector->used_slots + 1)) \
+        return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    data = name##_data(vector); \
+    memmove(data + idx + 1, data + idx, (vector->used_slots - idx) * sizeof(T)); \
+    data[idx] = element; \
+    vector->used_slots++; \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_remove_index(name##_t * vector, int idx) { \
+    return name##_remove_range(vector, idx, 1); \
+} \
+\
+int name##_remove_range(name##_t * vector, int idx, int count) { \
+    T * data = name##_data(vector); \
+    uint32_t new_slots; \
+    if (!(idx >= 0 && count >= 0 && (size_t)idx + count <= vector->used_slots)) \
+        return VEC_INDEX_OUT_OF_BOUNDS; \
+    if (count == 0) \
+        return VEC_SUCCESS; \
+    memmove(data + idx, data + idx + count, (vector->used_slots - idx - count) * sizeof(T)); \
+    vector->used_slots -= count; \
+    memset(data + vector->used_slots, 0, count * sizeof(T)); \
+    /* shrink if now use 1/4 space as allocated, keeping room to grow again */ \
+    if (vector->array != NULL && vector->used_slots < vector->allocated_slots / 4 \
+            && vector->allocated_slots > TVEC_MIN_SIZE) { \
+        new_slots = vector->used_slots * 2; \
+        if (new_slots < TVEC_MIN_SIZE) \
+            new_slots = TVEC_MIN_SIZE; \
+        if (name##_resize(vector, new_slots)) \
+            return VEC_COULD_NOT_ALLOCATE_MEMORY; \
+    } \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_reserve(name##_t * vector, int capacity) { \
+    if (capacity < 0) \
+        return VEC_INVALID_ARGUMENT; \
+    if ((uint32_t)capacity <= vector->allocated_slots) \
+        return VEC_SUCCESS; \
+    return name##_resize(vector, capacity); \
+} \
+\
+int name##_shrink_to_fit(name##_t * vector) { \
+    if (vector->array == NULL || vector->used_slots == vector->allocated_slots) \
+        return VEC_SUCCESS; \
+    return name##_resize(vector, vector->used_slots > 0 ? vector->used_slots : 1); \
+} \
+\
+int name##_sort(name##_t * vector, int (*cmp)(const void *, const void *)) { \
+    qsort(name##_data(vector), vector->used_slots, sizeof(T), cmp); \
+    return VEC_SUCCESS; \
+} \
+\
+int name##_destroy(name##_t * vector) { \
+    if (vector->allocated_slots == 0) \
+        return VEC_ALREADY_DESTROYED; \
+    free(vector->array); \
+    memset(vector, 0, sizeof(name##_t)); \
+    return VEC_SUCCESS; \
+}
+
+/**
+ * same as TVEC_ITER, for vectors made with SMALL_VEC_DECLARE.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define SMALL_VEC_ITER(vector, element_ptr, expression) ({\
+        int _ret = VEC_SUCCESS;\
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            element_ptr = ((vector)->array != NULL ? (vector)->array : (vector)->inline_slots) + _i;\
+            expression;\
+        }\
+        _ret;\
+})
+#endif
@@ -3,72 +3,247 @@
 #include "vec.h"
 
 #define MIN_SIZE 64
+#define DEFAULT_GROWTH_FACTOR 2.0f
+#define DEFAULT_SHRINK_DIVISOR 4
 
-int grow(vec_t * vector) {
-    void * tmp = realloc(vector->array, vector->allocated_slots * 2 * vector->element_size);
+static float growth_factor(vec_t * vector) {
+    if (vector->policy.growth_factor > 1.0f)
+        return vector->policy.growth_factor;
+    return DEFAULT_GROWTH_FACTOR;
+}
+
+static uint32_t shrink_divisor(vec_t * vector) {
+    if (vector->policy.shrink_divisor > 0)
+        return vector->policy.shrink_divisor;
+    return DEFAULT_SHRINK_DIVISOR;
+}
+
+#ifdef VEC_STATS
+//counts a resize from old_slots slots at old_array to the vector's current array
+static void count_resize(vec_t * vector, uintptr_t old_array, uint32_t old_slots) {
+    uint32_t kept = old_slots < vector->allocated_slots ? old_slots : vector->allocated_slots;
+
+    vector->stats.reallocs++;
+    if (vector->allocated_slots > old_slots)
+        vector->stats.grows++;
+    else
+        vector->stats.shrinks++;
+
+    //realloc only copies when it could not resize in place
+    if ((uintptr_t)vector->array != old_array)
+        vector->stats.bytes_copied += (uint64_t)kept * vector->element_size;
+
+    if (vector->allocated_slots > vector->stats.peak_allocated_slots)
+        vector->stats.peak_allocated_slots = vector->allocated_slots;
+}
+
+//counts a new array for a vector with nothing allocated
+static void count_allocation(vec_t * vector) {
+    vector->stats.allocations++;
+    if (vector->allocated_slots > vector->stats.peak_allocated_slots)
+        vector->stats.peak_allocated_slots = vector->allocated_slots;
+}
+#endif
+
+static int resize(vec_t * vector, uint32_t new_slots) {
+#ifdef VEC_STATS
+    uintptr_t old_array = (uintptr_t)vector->array;
+    uint32_t old_slots = vector->allocated_slots;
+#endif
+    void * tmp;
+
+    //the size of the array must not wrap around, reserve takes any capacity
+    if (vector->element_size != 0 && (size_t)new_slots > SIZE_MAX / vector->element_size)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    tmp = vec_mem_realloc(vector->allocator, vector->array,
+            (size_t)vector->allocated_slots * vector->element_size,
+            (size_t)new_slots * vector->element_size);
     if (tmp == NULL) 
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
     vector->array = tmp;
-    vector->allocated_slots *= 2;
+    vector->allocated_slots = new_slots;
+
+#ifdef VEC_STATS
+    count_resize(vector, old_array, old_slots);
+#endif
 
     return VEC_SUCCESS;
 }
 
+int grow(vec_t * vector, uint32_t needed) {
+    uint32_t new_slots = vector->allocated_slots;
+    float factor = growth_factor(vector);
+    double next;
+
+    //already big enough, nothing to do
+    if (needed <= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    //keep growing by the policy's factor until it fits so a bulk insert only reallocs once
+    while (new_slots < needed) {
+        next = (double)new_slots * factor;
+        if (new_slots == 0)
+            new_slots = MIN_SIZE;
+        else if (next > UINT32_MAX)
+            new_slots = needed;
+        else if ((uint32_t)next <= new_slots)
+            new_slots++;
+        else
+            new_slots = (uint32_t)next;
+    }
+
+    return resize(vector, new_slots);
+}
+
 int shrink(vec_t * vector) {
-    void * tmp = realloc(vector->array, vector->allocated_slots * vector->element_size / 2);
-    if (tmp == NULL) 
-        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    uint32_t new_slots;
+    double target;
 
-    vector->array = tmp;
-    vector->allocated_slots /= 2;
+    //never shrink below the minimum, or at all if the policy says so
+    if ((vector->policy.flags & VEC_NEVER_SHRINK) || vector->allocated_slots <= MIN_SIZE)
+        return VEC_SUCCESS;
 
-    return VEC_SUCCESS;
+    //only shrink once usage drops below 1/shrink_divisor of the allocation
+    if (vector->used_slots >= vector->allocated_slots / shrink_divisor(vector))
+        return VEC_SUCCESS;
+
+    //leave one growth step of headroom so a vector hovering around the
+    //threshold does not realloc back and forth
+    target = (double)vector->used_slots * growth_factor(vector);
+    new_slots = target < MIN_SIZE ? MIN_SIZE : (uint32_t)target;
+    if (new_slots >= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    return resize(vector, new_slots);
 }
 
 int init (vec_t * vector, size_t element_size) {
+    return init_with_capacity(vector, element_size, MIN_SIZE);
+}
+
+int init_with_capacity(vec_t * vector, size_t element_size, int capacity) {
     //check already initialized
     if (vector->array != NULL && vector->allocated_slots > 0) 
         return VEC_ALREADY_INITIALIZED;
 
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    //always hold at least one slot so the vector reads as initialized
+    if (capacity == 0)
+        capacity = 1;
+
+    //the size of the array must not wrap around
+    if (element_size != 0 && (size_t)capacity > SIZE_MAX / element_size)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
     vector->element_size = element_size;
     vector->used_slots = 0;
 
-    vector->allocated_slots = MIN_SIZE;
-    vector->array = calloc(MIN_SIZE, element_size);
+    vector->allocated_slots = capacity;
+    vector->array = vec_mem_alloc(vector->allocator, (size_t)capacity * element_size);
 
     //check memory allocation
     if (vector->array == NULL) 
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
+#ifdef VEC_STATS
+    count_allocation(vector);
+#endif
+
     //everything is good
     return VEC_SUCCESS;
 }
+
+int init_with_allocator(vec_t * vector, size_t element_size, int capacity, const vec_allocator_t * allocator) {
+    //check already initialized
+    if (vector->array != NULL && vector->allocated_slots > 0) 
+        return VEC_ALREADY_INITIALIZED;
+
+    vector->allocator = allocator;
+    return init_with_capacity(vector, element_size, capacity);
+}
+
+int reserve(vec_t * vector, int capacity) {
+    if (capacity < 0)
+        return VEC_INVALID_ARGUMENT;
+
+    if ((uint32_t)capacity <= vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    //grow to exactly the requested size, the caller knows best
+    return resize(vector, capacity);
+}
+
+int shrink_to_fit(vec_t * vector) {
+    uint32_t new_slots = vector->used_slots > 0 ? vector->used_slots : 1;
+
+    if (new_slots == vector->allocated_slots)
+        return VEC_SUCCESS;
+
+    return resize(vector, new_slots);
+}
+
+int set_policy(vec_t * vector, vec_policy_t * policy) {
+    vec_policy_t defaults = VEC_DEFAULT_POLICY;
+    float factor;
+
+    if (policy == NULL)
+        policy = &defaults;
+
+    //0 means use the default for each field
+    if (policy->growth_factor != 0.0f && !(policy->growth_factor > 1.0f))
+        return VEC_INVALID_ARGUMENT;
+
+    //a vector that shrinks to within one growth step of the threshold would thrash
+    factor = policy->growth_factor > 1.0f ? policy->growth_factor : DEFAULT_GROWTH_FACTOR;
+    if (policy->shrink_divisor != 0 && !(policy->shrink_divisor > factor))
+        return VEC_INVALID_ARGUMENT;
+
+    vector->policy = *policy;
+
+    return VEC_SUCCESS;
+}
+
 int insert(vec_t * vector, void * element_ptr, int idx) {
-    int i;
-    //check that have enough space, grow if necesary
-    if (vector->used_slots == vector->allocated_slots - 1) {
-        if (grow(vector)) 
-            return VEC_COULD_NOT_ALLOCATE_MEMORY;
-    }
+    return insert_range(vector, element_ptr, 1, idx);
+}
 
+int insert_range(vec_t * vector, void * elements, int count, int idx) {
     //check bounds
-    if (!(idx >=0 && (size_t)idx <= vector->used_slots)) 
+    if (!(idx >=0 && (size_t)idx <= vector->used_slots) || count < 0) 
         return VEC_INDEX_OUT_OF_BOUNDS;
-    
-    //move everything over one
-    for (i = vector->used_slots; i > idx; i--) {
-        memcpy(vector->array + (i) * vector->element_size,
-                vector->array + (i - 1) * vector->element_size,
-                vector->element_size);
-    }
+
+    if (count == 0)
+        return VEC_SUCCESS;
+
+    if (elements == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check that have enough space, grow once if necesary
+    if ((uint32_t)count > UINT32_MAX - vector->used_slots)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    if (grow(vector, vector->used_slots + count)) 
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //the index has to see the elements before they move
+    if (vector->index != NULL && vector->index->inserting(vector, elements, idx, count))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //move the tail over by count in one go
+    if ((uint32_t)idx < vector->used_slots)
+        VEC_STAT_SHIFT(vector, (size_t)(vector->used_slots - idx) * vector->element_size);
+    memmove(vector->array + (idx + count) * vector->element_size,
+            vector->array + idx * vector->element_size,
+            (vector->used_slots - idx) * vector->element_size);
     //insert
-    memcpy(vector->array + idx * vector->element_size, element_ptr, vector->element_size);
+    memcpy(vector->array + idx * vector->element_size, elements, count * vector->element_size);
 
-    vector->used_slots++;
+    vector->used_slots += count;
 
     return VEC_SUCCESS;
-
 }
 
 int replace(vec_t * vector, void * element_ptr, int idx) {
@@ -76,6 +251,9 @@ int replace(vec_t * vector, void * element_ptr, int idx) {
     if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
         return VEC_INDEX_OUT_OF_BOUNDS;
 
+    if (vector->index != NULL)
+        vector->index->replacing(vector, element_ptr, idx);
+
     //overwrite the other thing
     memcpy(vector->array + idx * vector->element_size, element_ptr, vector->element_size);
     return VEC_SUCCESS;
@@ -85,38 +263,111 @@ int replace(vec_t * vector, void * element_ptr, int idx) {
 int append(vec_t * vector, void * element_ptr) {
     return insert(vector, element_ptr, vector->used_slots);
 }
+
+int append_n(vec_t * vector, void * elements, int count) {
+    return insert_range(vector, elements, count, vector->used_slots);
+}
 int veclen(vec_t * vector) {
     return vector->used_slots;
 }
 int remove_index(vec_t * vector, int idx) {
-    int i;
+    return remove_range(vector, idx, 1);
+}
+
+int remove_range(vec_t * vector, int idx, int count) {
     //check bounds
-    if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
+    if (!(idx >=0 && count >= 0 && (size_t)idx + count <= vector->used_slots)) 
         return VEC_INDEX_OUT_OF_BOUNDS;
+
+    if (count == 0)
+        return VEC_SUCCESS;
+
+    if (vector->index != NULL)
+        vector->index->removing(vector, idx, count);
     
-    //move everything over one
-    for (i = idx; (size_t)i < vector-> used_slots; i++) {
-        memcpy(vector->array + (i) * vector->element_size,
-                vector->array + (i + 1) * vector->element_size,
-                vector->element_size);
-    }
+    //move the tail over by count in one go
+    if ((uint32_t)(idx + count) < vector->used_slots)
+        VEC_STAT_SHIFT(vector, (size_t)(vector->used_slots - idx - count) * vector->element_size);
+    memmove(vector->array + idx * vector->element_size,
+            vector->array + (idx + count) * vector->element_size,
+            (vector->used_slots - idx - count) * vector->element_size);
 
     //zero out what was last
-    memset(vector->array + (--vector->used_slots) * vector->element_size, 0, vector->element_size);
+    vector->used_slots -= count;
+    memset(vector->array + vector->used_slots * vector->element_size, 0, count * vector->element_size);
+
+    //shrink if usage dropped below what the policy allows
+    if (shrink(vector))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
 
-    //shrink if now use 1/4 space as allocated
-    if (vector->used_slots < vector->allocated_slots/4 && vector->allocated_slots > MIN_SIZE) {
-        if (!shrink(vector))
-            return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    return VEC_SUCCESS;
+}
+int swap_remove(vec_t * vector, int idx) {
+    uint32_t last;
+
+    //check bounds
+    if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    if (vector->index != NULL)
+        vector->index->swap_removing(vector, idx);
+
+    //the last element fills the hole
+    last = vector->used_slots - 1;
+    if ((uint32_t)idx != last) {
+        VEC_STAT_SHIFT(vector, vector->element_size);
+        memcpy(vector->array + idx * vector->element_size, vector->array + last * vector->element_size, vector->element_size);
     }
 
+    //zero out what was last
+    vector->used_slots = last;
+    memset(vector->array + last * vector->element_size, 0, vector->element_size);
+
+    //shrink if usage dropped below what the policy allows
+    if (shrink(vector))
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
     return VEC_SUCCESS;
 }
+int swap_remove_element(vec_t * vector, void * element_ptr) {
+    uint32_t idx;
+    int i;
+    if (element_ptr == NULL) 
+        return VEC_NULL_BUFFER;
+
+    if (vector->index != NULL) {
+        if (vector->index->find_element(vector, element_ptr, &idx))
+            return VEC_NOT_FOUND;
+        return swap_remove(vector, idx);
+    }
+
+    for (i = 0; (size_t)i < vector->used_slots; i++) {
+        if (memcmp(vector->array + i * vector->element_size, element_ptr, vector->element_size) == 0) {
+            return swap_remove(vector, i);
+        }
+    }
+    return VEC_NOT_FOUND;
+}
+int vec_truncate(vec_t * vector, int len) {
+    //check bounds
+    if (!(len >= 0 && (size_t)len <= vector->used_slots)) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    return remove_range(vector, len, vector->used_slots - len);
+}
 int remove_element(vec_t * vector, void * element_ptr) {
+    uint32_t idx;
     int i;
     if (element_ptr == NULL) 
         return VEC_NULL_BUFFER;
 
+    //with an index there is no need to scan
+    if (vector->index != NULL) {
+        if (vector->index->find_element(vector, element_ptr, &idx))
+            return VEC_NOT_FOUND;
+        return remove_index(vector, idx);
+    }
+
     for (i = 0; (size_t)i < vector->used_slots; i++) {
         if (memcmp(vector->array + i * vector->element_size, element_ptr, vector->element_size) == 0) {
             return remove_index(vector, i);
@@ -136,33 +387,188 @@ int get(vec_t * vector, int idx, void * element_buffer) {
 
     return VEC_SUCCESS;
 }
+int get_ptr(vec_t * vector, int idx, void ** element_ptr) {
+    if (element_ptr == NULL) 
+        return VEC_NULL_BUFFER;
+
+    //check bounds
+    if (!(idx >=0 && (size_t)idx < vector->used_slots)) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    *element_ptr = vector->array + idx * vector->element_size;
+
+    return VEC_SUCCESS;
+}
+void * vec_data(vec_t * vector) {
+    return vector->array;
+}
+int vec_span(vec_t * vector, int begin, int end, void ** span_ptr) {
+    if (span_ptr == NULL) 
+        return VEC_NULL_BUFFER;
+
+    //check bounds, an empty span at the end is fine
+    if (!(begin >= 0 && begin <= end && (size_t)end <= vector->used_slots)) 
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    *span_ptr = vector->array + begin * vector->element_size;
+
+    return VEC_SUCCESS;
+}
 int destroy(vec_t * vector) {
     if (vector->array == NULL)
         return VEC_ALREADY_DESTROYED;
 
-    free(vector->array);
+    if (vector->index != NULL)
+        vector->index->destroy(vector);
+
+    vec_mem_free(vector->allocator, vector->array, (size_t)vector->allocated_slots * vector->element_size);
     memset(vector, 0,sizeof(vec_t));
 
     return VEC_SUCCESS;
 }
 int sort(vec_t * vector, cmpfn cmp) {
     qsort(vector->array,vector->used_slots, vector->element_size,cmp);
+    return VEC_INDEX_REFRESH(vector);
+}
+
+//first index whose element is not less than key, or with upper set, not less or equal
+static uint32_t bound(vec_t * vector, void * key, cmpfn cmp, int upper) {
+    uint32_t lo = 0, hi = vector->used_slots, mid;
+    int c;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        c = cmp(key, vector->array + (size_t)mid * vector->element_size);
+        if (c > 0 || (upper && c == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+int vec_lower_bound(vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    *idx = bound(vector, key, cmp, 0);
+    return VEC_SUCCESS;
+}
+
+int vec_upper_bound(vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    *idx = bound(vector, key, cmp, 1);
     return VEC_SUCCESS;
 }
 
+int vec_bsearch(vec_t * vector, void * key, cmpfn cmp, int * idx) {
+    uint32_t i;
+
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    //the first equal element, or where key would go
+    i = bound(vector, key, cmp, 0);
+    *idx = i;
+
+    if (i < vector->used_slots && cmp(key, vector->array + (size_t)i * vector->element_size) == 0)
+        return VEC_SUCCESS;
+    return VEC_NOT_FOUND;
+}
+
+int insert_sorted(vec_t * vector, void * element_ptr, cmpfn cmp) {
+    if (element_ptr == NULL)
+        return VEC_NULL_BUFFER;
+
+    //after any equal elements, so equal elements stay in insertion order
+    return insert(vector, element_ptr, bound(vector, element_ptr, cmp, 1));
+}
+
+int remove_sorted(vec_t * vector, void * element_ptr, cmpfn cmp) {
+    int idx, res;
+
+    if ((res = vec_bsearch(vector, element_ptr, cmp, &idx)))
+        return res;
+
+    return remove_index(vector, idx);
+}
+
+int merge_sorted(vec_t * vector, void * elements, int count, cmpfn cmp) {
+    size_t element_size = vector->element_size;
+    size_t bytes = (size_t)count * element_size;
+    void * batch;
+    int64_t i, j, k;
+
+    if (count < 0)
+        return VEC_INDEX_OUT_OF_BOUNDS;
+
+    if (count == 0)
+        return VEC_SUCCESS;
+
+    if (elements == NULL)
+        return VEC_NULL_BUFFER;
+
+    //check that have enough space, grow once if necesary
+    if ((uint32_t)count > UINT32_MAX - vector->used_slots)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    if (grow(vector, vector->used_slots + count)) 
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //sort a copy of the batch, the caller's array is left alone. The copy is scratch
+    //space, so it comes from the system like the sorts' buffers, not the vector's allocator
+    batch = vec_mem_alloc(NULL, bytes);
+    if (batch == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    memcpy(batch, elements, bytes);
+    qsort(batch, count, element_size, cmp);
+
+    //merge from the back into the free slots at the end, so nothing is moved twice.
+    //on ties the vector's elements stay in front of the batch's
+    i = (int64_t)vector->used_slots - 1;
+    j = count - 1;
+    k = i + count;
+    while (j >= 0) {
+        if (i >= 0 && cmp(vector->array + i * element_size, batch + j * element_size) > 0) {
+            memcpy(vector->array + k * element_size, vector->array + i * element_size, element_size);
+            i--;
+        } else {
+            memcpy(vector->array + k * element_size, batch + j * element_size, element_size);
+            j--;
+        }
+        k--;
+    }
+
+    //everything after i moved up to make room
+    if (i + 1 < (int64_t)vector->used_slots)
+        VEC_STAT_SHIFT(vector, (size_t)(vector->used_slots - 1 - i) * element_size);
+
+    vector->used_slots += count;
+    vec_mem_free(NULL, batch, bytes);
+
+    return VEC_INDEX_REFRESH(vector);
+}
+
 int copy(vec_t * srcvec, vec_t * dstvec) {
     //check already initialized
     if (dstvec->array != NULL && dstvec->allocated_slots > 0) 
         return VEC_ALREADY_INITIALIZED;
 
     dstvec->element_size = srcvec->element_size;
+    dstvec->policy = srcvec->policy;
     dstvec->used_slots = srcvec->used_slots;
     dstvec->allocated_slots = srcvec->allocated_slots;
-    dstvec->array = calloc(srcvec->allocated_slots, srcvec->element_size);
+    dstvec->array = vec_mem_alloc(dstvec->allocator, (size_t)srcvec->allocated_slots * srcvec->element_size);
 
     //check memory allocation
     if (dstvec->array == NULL) 
         return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+#ifdef VEC_STATS
+    count_allocation(dstvec);
+#endif
     
     memcpy(dstvec->array, srcvec->array, srcvec->allocated_slots * srcvec->element_size);
 
@@ -181,3 +587,23 @@ int to_array(vec_t * vec, void ** resultptr) {
 
     return VEC_SUCCESS;
 }
+
+#ifdef VEC_STATS
+int vec_stats_get(vec_t * vector, vec_stats_t * stats) {
+    if (stats == NULL)
+        return VEC_NULL_BUFFER;
+
+    *stats = vector->stats;
+    stats->wasted_slots = vector->allocated_slots - vector->used_slots;
+    stats->wasted_bytes = (uint64_t)stats->wasted_slots * vector->element_size;
+
+    return VEC_SUCCESS;
+}
+
+int vec_stats_reset(vec_t * vector) {
+    memset(&vector->stats, 0, sizeof(vec_stats_t));
+    vector->stats.peak_allocated_slots = vector->allocated_slots;
+
+    return VEC_SUCCESS;
+}
+#endif
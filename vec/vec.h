@@ -2,26 +2,90 @@
 
 #define VEC_H
 
-#define VEC_SUCCESS 0
-#define VEC_INDEX_OUT_OF_BOUNDS 1 
-#define VEC_COULD_NOT_ALLOCATE_MEMORY 2
-#define VEC_NOT_FOUND 3
-#define VEC_ALREADY_INITIALIZED 4
-#define VEC_ALREADY_DESTROYED 5
-#define VEC_NULL_BUFFER 6
-
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include "../vec_errors.h"
+#include "../vec_types.h"
+#include "../alloc/vec_alloc.h"
+#include "../sort/sort_by.h"
+
+struct vec_index;
+
+#ifdef VEC_STATS
+/**
+ * what a vector has done with its memory, kept when the library and everything including
+ * vec.h are compiled with -DVEC_STATS (cmake -DVEC_STATS=ON). See vec_stats_get.
+ *  allocations:    arrays allocated from nothing, by init, init_with_capacity and copy
+ *  reallocs:       resizes of the array, grows and shrinks together
+ *  grows, shrinks: the reallocs that made the array larger or smaller
+ *  bytes_copied:   bytes realloc had to copy because the array could not be resized in place
+ *  shifts:         insert_range, remove_range, swap_remove and merge_sorted calls that moved
+ *                  elements already in the vector
+ *  bytes_shifted:  bytes those calls moved
+ *  peak_allocated_slots: the most slots the array has held at once
+ *  wasted_slots, wasted_bytes: slots allocated but not in use, as of vec_stats_get
+ */
+typedef struct {
+    uint64_t allocations;
+    uint64_t reallocs;
+    uint64_t grows;
+    uint64_t shrinks;
+    uint64_t bytes_copied;
+    uint64_t shifts;
+    uint64_t bytes_shifted;
+    uint32_t peak_allocated_slots;
+    uint32_t wasted_slots;
+    uint64_t wasted_bytes;
+} vec_stats_t;
+
+//counts a move of bytes bytes of elements already in the vector
+#define VEC_STAT_SHIFT(vector, bytes) ({\
+        (vector)->stats.shifts++;\
+        (vector)->stats.bytes_shifted += (bytes);\
+})
+#else
+#define VEC_STAT_SHIFT(vector, bytes) ((void)0)
+#endif
 
 typedef struct {
     uint32_t allocated_slots;
     uint32_t used_slots;
     size_t element_size;
+    vec_policy_t policy;
     void * array;
+    const vec_allocator_t * allocator;
+    struct vec_index * index;
+#ifdef VEC_STATS
+    vec_stats_t stats;
+#endif
 } vec_t;
 
-typedef int (*cmpfn)(const void*,const void*);
+/**
+ * hooks an index over the vector (see vec_index_enable) uses to follow every change.
+ * They are function pointers, like the allocator, so vec.c only depends on vec_index.c
+ * when an index is actually used. inserting and removing are called before the elements
+ * move, with the vector still as it was.
+ *  inserting:  count elements from the elements array are about to be inserted at idx
+ *  removing:   the count elements at idx are about to be removed
+ *  swap_removing: the element at idx is about to be removed and the last element moved into its place
+ *  replacing:  the element at idx is about to be overwritten with element_ptr
+ *  rebuild:    the elements were changed in bulk, index them from scratch
+ *  find_element: sets idx to the first position holding a copy of element_ptr
+ *  destroy:    the vector is being destroyed, free the index
+ */
+struct vec_index {
+    int (*inserting)(vec_t * vector, void * elements, uint32_t idx, uint32_t count);
+    void (*removing)(vec_t * vector, uint32_t idx, uint32_t count);
+    void (*swap_removing)(vec_t * vector, uint32_t idx);
+    void (*replacing)(vec_t * vector, void * element_ptr, uint32_t idx);
+    int (*rebuild)(vec_t * vector);
+    int (*find_element)(vec_t * vector, void * element_ptr, uint32_t * idx);
+    void (*destroy)(vec_t * vector);
+};
+
+//brings the vector's index, if it has one, back in line after a bulk change
+#define VEC_INDEX_REFRESH(vector) ((vector)->index != NULL ? (vector)->index->rebuild(vector) : VEC_SUCCESS)
 
 /**
  * given a pointer to a vec_t struct, and the size of
@@ -37,6 +101,61 @@ typedef int (*cmpfn)(const void*,const void*);
  */
 int init (vec_t * vector, size_t element_size);
 
+/**
+ * same as init, but allocates room for capacity elements up front
+ * so a vector of known size never has to grow.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int init_with_capacity(vec_t * vector, size_t element_size, int capacity);
+
+/**
+ * same as init_with_capacity, but all of the vector's memory comes from allocator
+ * instead of calloc/realloc/free. allocator must outlive the vector. See alloc/vec_alloc.h
+ * for the bump arena and size class pool that come with the library.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_INVALID_ARGUMENT
+ */
+int init_with_allocator(vec_t * vector, size_t element_size, int capacity, const vec_allocator_t * allocator);
+
+/**
+ * makes sure the vector has room for at least capacity elements,
+ * growing to exactly that size if it does not.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT
+ */
+int reserve(vec_t * vector, int capacity);
+
+/**
+ * releases any unused slots so the allocation matches the length.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int shrink_to_fit(vec_t * vector);
+
+/**
+ * sets the growth and shrink policy of the vector. Passing NULL restores
+ * the defaults.  The policy is copied, so policy can be a local.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INVALID_ARGUMENT
+ */
+int set_policy(vec_t * vector, vec_policy_t * policy);
+
 /**
  * appends the item pointed to by the element_ptr
  * to the end of the array. grows if needed
@@ -47,6 +166,18 @@ int init (vec_t * vector, size_t element_size);
  */
 int append(vec_t * vector, void * element_ptr); 
 
+/**
+ * appends count items from the elements array to the end of the vector.
+ * grows at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int append_n(vec_t * vector, void * elements, int count);
+
 /**
  * inserts the item pointed to by the element_ptr into
  * the given index, shifting everything else over to the left.
@@ -58,6 +189,18 @@ int append(vec_t * vector, void * element_ptr);
  */
 int insert(vec_t * vector, void * element_ptr, int idx);
 
+/**
+ * inserts count items from the elements array starting at the given index,
+ * shifting everything else over with a single move. grows at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int insert_range(vec_t * vector, void * elements, int count, int idx);
+
 /**
  * overwrites the item at the given index with the contents of the
  * element_ptr buffer. Be sure to not leak memory when using this!
@@ -77,7 +220,7 @@ int veclen(vec_t * vector);
  * removes the given item that is equivalent to the 
  * element pointed to by element_ptr and shifts everything
  * else over to the left. Shrinks the array
- * if less than 1/4 of the allocated space is in use.
+ * if less than 1/4 (or the policy's shrink_divisor) of the allocated space is in use.
  * 
  * possible return values:
  *  VEC_SUCCESS
@@ -90,7 +233,7 @@ int remove_element(vec_t * vector, void * element_ptr);
 /**
  * removes the given item that is at the given index
  * and shifts everything else over to the left. Shrinks the array
- * if less than 1/4 of the allocated space is in use.
+ * if less than 1/4 (or the policy's shrink_divisor) of the allocated space is in use.
  * 
  * possible return values:
  *  VEC_SUCCESS
@@ -99,6 +242,54 @@ int remove_element(vec_t * vector, void * element_ptr);
  */
 int remove_index(vec_t * vector, int idx);
 
+/**
+ * removes count items starting at the given index and shifts everything
+ * else over to the left with a single move. Shrinks the array at most once
+ * if less than 1/4 (or the policy's shrink_divisor) of the allocated space is in use.
+ * 
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ */
+int remove_range(vec_t * vector, int idx, int count);
+
+/**
+ * removes the item at the given index by moving the last item into its place,
+ * so nothing else moves and the removal is O(1). The order of the vector is
+ * not kept. Shrinks the array if less than 1/4 (or the policy's shrink_divisor)
+ * of the allocated space is in use.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ */
+int swap_remove(vec_t * vector, int idx);
+
+/**
+ * finds the first item equivalent to the element pointed to by element_ptr,
+ * like remove_element, and removes it with swap_remove.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ *  VEC_NOT_FOUND
+ */
+int swap_remove_element(vec_t * vector, void * element_ptr);
+
+/**
+ * removes every element from position len on, as one remove_range, so the vector
+ * shrinks at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS if len is negative or larger than the vector
+ */
+int vec_truncate(vec_t * vector, int len);
+
 /**
  * gets the item at the given index and copies it into 
  * the memory pointed to by element_buffer
@@ -110,6 +301,35 @@ int remove_index(vec_t * vector, int idx);
  */
 int get(vec_t * vector, int idx, void * element_buffer);
 
+/**
+ * sets element_ptr to point at the item at the given index inside the vector
+ * instead of copying it out. The pointer is only valid until the next call that
+ * grows, shrinks or shifts the vector.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int get_ptr(vec_t * vector, int idx, void ** element_ptr);
+
+/**
+ * returns a pointer to the vector's internal array, which holds veclen(vector)
+ * contiguous elements. Same lifetime rules as get_ptr.
+ */
+void * vec_data(vec_t * vector);
+
+/**
+ * sets span_ptr to point at the elements in [begin, end) inside the vector.
+ * the span holds end - begin contiguous elements. Same lifetime rules as get_ptr.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_INDEX_OUT_OF_BOUNDS
+ *  VEC_NULL_BUFFER
+ */
+int vec_span(vec_t * vector, int begin, int end, void ** span_ptr);
+
 /**
  * frees all memory given to this vector
  *
@@ -120,17 +340,172 @@ int get(vec_t * vector, int idx, void * element_buffer);
 int destroy(vec_t * vector);
 
 /**
- * sorts the array in place. Always succeeds.
+ * sorts the array in place, then rebuilds the vector's index if it has one.
  *
  * possible return values:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY if the index could not be rebuilt
  */
 int sort(vec_t * vector,cmpfn cmp);
 
+/**
+ * sorts the array in place like sort, but spread over nthreads threads
+ * (nthreads <= 0 uses one per cpu) with the parallel merge sort in sort/psort.h.
+ * Small vectors fall back to a single qsort. The merge scratch space comes from
+ * calloc, not the vector's allocator, which may only be able to hold the array
+ * (like the one of vec_open_mmap).  Implemented in vec_sort.c, link with -lpthread.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int parallel_sort(vec_t * vector, cmpfn cmp, int nthreads);
+
+/**
+ * sorts the vector by the integer key of key_width bytes (1, 2, 4 or 8) found key_offset
+ * bytes into each element, for example offsetof(struct x, id) and sizeof(uint32_t).
+ * flags is VEC_RADIX_UNSIGNED or VEC_RADIX_SIGNED. An LSD radix sort, so it takes
+ * key_width passes over the data no matter how many elements there are, and skips the
+ * passes for bytes that are the same in every key. Unlike sort it is stable. The scratch
+ * buffer it needs, as large as the array, comes from calloc like parallel_sort's.
+ * Implemented in vec_sort.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INVALID_ARGUMENT if key_width is not 1, 2, 4 or 8, or the key does not fit in the element
+ */
+int radix_sort(vec_t * vector, size_t key_offset, size_t key_width, int flags);
+
+/**
+ * the functions below work on a vector kept sorted by cmp, for example with sort
+ * and then only changed through insert_sorted, remove_sorted and merge_sorted.
+ * They find positions with a binary search instead of a scan. cmp is called like
+ * bsearch's, as cmp(key, element), so key can be a full element or just enough of
+ * one for cmp to look at.
+ */
+
+/**
+ * sets idx to the first position whose element is not less than key,
+ * veclen(vector) if there is none. Always finds a position.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NULL_BUFFER
+ */
+int vec_lower_bound(vec_t * vector, void * key, cmpfn cmp, int * idx);
+
+/**
+ * sets idx to the first position whose element is greater than key,
+ * veclen(vector) if there is none. Always finds a position.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NULL_BUFFER
+ */
+int vec_upper_bound(vec_t * vector, void * key, cmpfn cmp, int * idx);
+
+/**
+ * sets idx to the position of the first element equal to key. If there is
+ * none, idx is set to where key would be inserted instead.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ *  VEC_NULL_BUFFER
+ */
+int vec_bsearch(vec_t * vector, void * key, cmpfn cmp, int * idx);
+
+/**
+ * inserts the item pointed to by element_ptr where it keeps the vector sorted,
+ * after any elements equal to it.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int insert_sorted(vec_t * vector, void * element_ptr, cmpfn cmp);
+
+/**
+ * removes the first element equal to the one pointed to by element_ptr,
+ * shrinking like remove_index.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NOT_FOUND
+ *  VEC_NULL_BUFFER
+ */
+int remove_sorted(vec_t * vector, void * element_ptr, cmpfn cmp);
+
+/**
+ * adds count unsorted items from the elements array, keeping the vector sorted.
+ * A copy of the batch is sorted in scratch space from calloc, then
+ * merged in from the back, so every element moves at most once: O(m log m + n)
+ * instead of the O(m * n) of m calls to insert_sorted. The elements array is not
+ * changed. Elements already in the vector stay in front of equal ones from the batch.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_INDEX_OUT_OF_BOUNDS if count is negative
+ *  VEC_NULL_BUFFER
+ */
+int merge_sorted(vec_t * vector, void * elements, int count, cmpfn cmp);
+
+/**
+ * parallel versions of VEC_MAP, VEC_FILTER and a reduce, for costly per element work
+ * on large vectors. The array is cut into chunks of about 256KB that the threads of a
+ * shared pool (started on first use, see par/vec_par.h) take in turn. The order of the
+ * elements is kept, and vectors under VEC_PAR_MIN (32768) elements are done by the
+ * calling thread alone. The functions passed in are called from several threads at
+ * once, so they must not change shared state without synchronizing.
+ * Implemented in vec_parallel.c, link with -lpthread.
+ */
+
+/**
+ * initializes dst with room for every element of src and calls fn(src_element, dst_element, ctx)
+ * on each element of src to fill out the matching element of dst. dst must be uninitialized,
+ * its memory comes from dst->allocator, which may be set on the zeroed vector beforehand.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+int vec_parallel_map(vec_t * src, vec_t * dst, size_t dst_element_size, vec_map_fn fn, void * ctx);
+
+/**
+ * removes every element pred(element, ctx) returns false for, keeping the order
+ * of the rest, and shrinks at most once.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+int vec_parallel_filter(vec_t * vector, vec_pred_fn pred, void * ctx);
+
+/**
+ * folds every element into the result_size bytes at result with fn(acc, element, ctx).
+ * result must hold the identity value of the reduction (0 for a sum) on entry: every
+ * chunk is folded into its own copy of it, and the chunk results are then folded into
+ * result in order with combine(acc, other, ctx). fn and combine must be associative,
+ * they need not be commutative.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NULL_BUFFER
+ */
+int vec_parallel_reduce(vec_t * vector, void * result, size_t result_size,
+        vec_reduce_fn fn, vec_combine_fn combine, void * ctx);
+
 /**
  * creates a copy of the vector. The source vector should have already been
  * initialized, while the destination vector should already be allocated but
- * not initalized
+ * not initalized. The copy's memory comes from dstvec->allocator, which may be
+ * set on the zeroed destination beforehand.
  *
  * possible return values:
  *  VEC_SUCCESS
@@ -151,6 +526,170 @@ int copy(vec_t * srcvec, vec_t * dstvec);
  */
 int to_array(vec_t * vec, void ** resultptr);
 
+#ifdef VEC_STATS
+/**
+ * copies the vector's counters into stats and fills in its wasted capacity.
+ * Only there when compiled with -DVEC_STATS. destroy clears the counters,
+ * so read them before.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NULL_BUFFER
+ */
+int vec_stats_get(vec_t * vector, vec_stats_t * stats);
+
+/**
+ * zeroes the vector's counters and restarts peak_allocated_slots from the current
+ * allocation, so the next vec_stats_get covers only what happened since.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ */
+int vec_stats_reset(vec_t * vector);
+#endif
+
+
+/**
+ * opens (or creates) a file backed vector at path. The element array is mapped straight
+ * from the file, so reopening a vector that was built earlier is nearly instant and reads
+ * never copy.  The vector grows and shrinks by resizing the file and remapping it, and
+ * otherwise works with every function in this file.  The length is stored in the file's
+ * header by vec_flush_mmap and vec_close_mmap, so always close the vector with
+ * vec_close_mmap instead of destroy.  Implemented in vec_mmap.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_IO_ERROR
+ *  VEC_BAD_FORMAT if the file is not a vector, holds elements of a different size or has a broken header
+ */
+int vec_open_mmap(vec_t * vector, const char * path, size_t element_size);
+
+/**
+ * writes the current length into the file's header and flushes the mapping to disk with msync.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_INVALID_ARGUMENT if the vector was not opened with vec_open_mmap
+ */
+int vec_flush_mmap(vec_t * vector);
+
+/**
+ * flushes the vector, unmaps it and closes the file. The vector is zeroed for reuse.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_INVALID_ARGUMENT if the vector was not opened with vec_open_mmap
+ */
+int vec_close_mmap(vec_t * vector);
+
+/**
+ * writes the vector to fd in the chunked stream format from io/vec_stream.h.
+ * Chunks are written straight from the array, so saving never needs a second copy
+ * of the data. fd is left open.  Implemented in vec_io.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_IO_ERROR
+ *  VEC_NULL_BUFFER
+ */
+int vec_save(vec_t * vector, int fd);
+
+/**
+ * reads a vector written by vec_save (or sync_save) from fd into an uninitialized vector.
+ * If vector->allocator is set it is used for the array.  Each chunk's crc is checked as it
+ * is read straight into the array.  On failure the vector is left uninitialized.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ *  VEC_IO_ERROR
+ *  VEC_BAD_FORMAT if the stream is truncated, corrupt or not a vector
+ */
+int vec_load(vec_t * vector, int fd);
+
+/**
+ * adds a hash index over the vector, so vec_find, vec_find_key and remove_element take O(1) expected time
+ * instead of a scan. The key is the key_size bytes at key_offset in each element, or the
+ * whole element if key_size is 0.  Every function in this file keeps the index up to date,
+ * including when elements shift, and the macros that let you change elements in place
+ * rebuild it afterwards.  If you write to elements yourself through get_ptr, vec_data or
+ * vec_span, call vec_index_rebuild when done.  The index takes 16 to 32 bytes per element
+ * from the system allocator, and is freed by destroy.  Implemented in vec_index.c.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED if the vector already has an index
+ *  VEC_INVALID_ARGUMENT if the key does not fit in the element
+ */
+int vec_index_enable(vec_t * vector, size_t key_offset, size_t key_size);
+
+/**
+ * drops the vector's index.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND if the vector has no index
+ */
+int vec_index_disable(vec_t * vector);
+
+/**
+ * indexes every element again, for after elements were changed through pointers.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_NOT_FOUND if the vector has no index
+ */
+int vec_index_rebuild(vec_t * vector);
+
+/**
+ * sets idx to the position of the first element equal to the one at element_ptr, the same
+ * element remove_element would remove. Uses the index if there is one, else scans.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ *  VEC_NULL_BUFFER
+ */
+int vec_find(vec_t * vector, void * element_ptr, int * idx);
+
+/**
+ * sets idx to the position of the first element whose key equals the key_size bytes at key,
+ * whatever the rest of the element holds. Needs an index, which defines the key.
+ *
+ * possible return values:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ *  VEC_NULL_BUFFER
+ *  VEC_INVALID_ARGUMENT if the vector has no index
+ */
+int vec_find_key(vec_t * vector, void * key, int * idx);
+
+/*
+ * ends the single pass compaction in VEC_FILTER and VEC_ITER_REMOVE. The _keep elements
+ * kept so far are at the front; if the loop was left early with break, everything from
+ * _i on is kept as well and slides down behind them. Then the vector is cut to length,
+ * shrinking at most once, and its index, if any, rebuilt. Evaluates to the result.
+ */
+#define _VEC_COMPACT_FINISH(vector, _i, _keep) ({\
+        int _res;\
+        if ((_i) < (vector)->used_slots) {\
+            memmove((vector)->array + (_keep) * (vector)->element_size,\
+                    (vector)->array + (_i) * (vector)->element_size,\
+                    ((vector)->used_slots - (_i)) * (vector)->element_size);\
+            (_keep) += (vector)->used_slots - (_i);\
+        }\
+        _res = vec_truncate(vector, _keep);\
+        if (_res == VEC_SUCCESS)\
+            _res = VEC_INDEX_REFRESH(vector);\
+        _res;\
+})
 
 /**
  * finds the element in the vector based on the given condition.
@@ -183,6 +722,32 @@ int to_array(vec_t * vec, void ** resultptr);
         _ret; \
 })
 
+/**
+ * same as VEC_FIND_BY, but tests the elements where they are instead of copying each one out.
+ * element_ptr is a x* variable, where x is the type that you are storing. On success
+ * it is left pointing at the found element inside the vector.
+ *
+ * Example:
+ *      struct x * ptr;
+ *      VEC_FIND_BY_PTR(vector, ptr, ptr->y == 1)
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ */
+#define VEC_FIND_BY_PTR(vector, element_ptr, condition) ({\
+        int _ret = VEC_NOT_FOUND; \
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) { \
+            element_ptr = (vector)->array + _i * (vector)->element_size; \
+            if (condition) { \
+                _ret = VEC_SUCCESS; \
+                break; \
+            } \
+        } \
+        _ret; \
+})
+
 /**
  * finds the element in the vector based on the given condition and removes it.
  * vector is a vec_t *. element_buffer is a x*, where x is the type that 
@@ -206,48 +771,87 @@ int to_array(vec_t * vec, void ** resultptr);
         _ret; \
 })
 
+/**
+ * same as VEC_REMOVE_BY, but removes the element with swap_remove, so the
+ * last element takes its place instead of everything after it shifting over.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_NOT_FOUND
+ */
+#define VEC_SWAP_REMOVE_BY(vector, element_buffer, condition) ({\
+        int _ret = VEC_NOT_FOUND; \
+        unsigned int _i;\
+            for (_i = 0; _i < (vector)->used_slots; _i++) { \
+                memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size); \
+                if (condition) { \
+                    _ret = VEC_SUCCESS; \
+                    swap_remove(vector, _i); \
+                    break; \
+                } \
+        } \
+        _ret; \
+})
+
 /**
  * creates a copy of the first vector and stores it in the second vector.
- * The copy keeps only the elements that satisfy the condition.
+ * The copy keeps only the elements that satisfy the condition, which are the only
+ * ones ever copied into it.  It gets the source's policy, and its memory comes from
+ * dstvector->allocator, which may be set on the zeroed destination beforehand.
  * srcvector is an initialized vec_t * , dstvector is an uninitailized vec_t *. 
  * element_buffer is a x*, where x is the type that you are storing. 
  * condition is a boolean expression involving your element_buffer.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
  */
 #define VEC_SELECT(srcvector, dstvector, element_buffer, condition) ({\
+        const vec_allocator_t * _allocator = (dstvector)->allocator;\
+        int _ret;\
         unsigned int _i;\
-        copy(srcvector, dstvector); \
-        for (_i = 0; _i < (dstvector)->used_slots; _i++) {\
-            memcpy(element_buffer, (dstvector)->array + _i * (dstvector)->element_size, (dstvector)->element_size); \
-            if (!(condition)) { \
-                remove_index(dstvector, _i); \
-                _i--;\
-            }\
+        _ret = init(dstvector, (srcvector)->element_size); \
+        /* an initialized destination is left alone, policy included */\
+        if (_ret == VEC_SUCCESS)\
+            (dstvector)->policy = (srcvector)->policy;\
+        for (_i = 0; _ret == VEC_SUCCESS && _i < (srcvector)->used_slots; _i++) {\
+            memcpy(element_buffer, (srcvector)->array + _i * (srcvector)->element_size, (srcvector)->element_size); \
+            if (condition) \
+                _ret = append(dstvector, (srcvector)->array + _i * (srcvector)->element_size); \
+        }\
+        /* on failure leave the destination as it was handed in, allocator included */\
+        if (_ret != VEC_SUCCESS && _ret != VEC_ALREADY_INITIALIZED) {\
+            destroy(dstvector);\
+            (dstvector)->allocator = _allocator;\
         }\
-        VEC_SUCCESS;\
+        _ret;\
 })
 
 /**
  * The removes the elements that do not satisfy the condition.
+ * The kept elements slide down in a single pass, keeping their order,
+ * and the vector shrinks at most once at the end.
  * vector is an initialized vec_t *. 
  * element_buffer is a x*, where x is the type that you are storing. 
  * condition is a boolean expression involving your element_buffer.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
  */
 #define VEC_FILTER(vector, element_buffer, condition) ({\
-        unsigned int _i;\
+        unsigned int _i, _keep = 0;\
+        size_t _es = (vector)->element_size;\
         for (_i = 0; _i < (vector)->used_slots; _i++) {\
-            memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size); \
-            if (!(condition)) { \
-                remove_index(vector, _i); \
-                _i--;\
+            memcpy(element_buffer, (vector)->array + _i * _es, _es); \
+            if (condition) { \
+                if (_keep != _i) \
+                    memcpy((vector)->array + _keep * _es, (vector)->array + _i * _es, _es); \
+                _keep++;\
             }\
         }\
-        VEC_SUCCESS;\
+        _VEC_COMPACT_FINISH(vector, _i, _keep);\
 })
 
 /**
@@ -287,7 +891,7 @@ int to_array(vec_t * vec, void ** resultptr);
             (dstvector)->element_size = mapped_ele_size; \
             (dstvector)->used_slots = (srcvector)->used_slots;\
             (dstvector)->allocated_slots = (srcvector)->allocated_slots;\
-            (dstvector)->array = calloc((srcvector)->allocated_slots, mapped_ele_size);\
+            (dstvector)->array = vec_mem_alloc((dstvector)->allocator, (size_t)(srcvector)->allocated_slots * (mapped_ele_size));\
             if ((dstvector)->array == NULL) \
                 _ret = VEC_COULD_NOT_ALLOCATE_MEMORY; \
             else { \
@@ -300,6 +904,45 @@ int to_array(vec_t * vec, void ** resultptr);
         }\
         _ret;\
 })
+
+/**
+ * same as VEC_MAP, but works on the elements in place instead of going through buffers.
+ * src_element_ptr is a x* variable and dst_element_ptr is a y* variable. expression
+ * reads from src_element_ptr and fills out dst_element_ptr, which points straight into
+ * the new vector.
+ *
+ * Example:
+ *      struct x * src;
+ *      struct w * dst;
+ *      VEC_MAP_PTR(vector,dstvec,sizeof(struct w), src, dst, dst->a = src->y % 128; dst->b = 100 * src->z;)
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ *  VEC_ALREADY_INITIALIZED
+ */
+#define VEC_MAP_PTR(srcvector, dstvector, mapped_ele_size, src_element_ptr, dst_element_ptr, expression) ({\
+        int _ret = VEC_SUCCESS; \
+        unsigned int _i;\
+        if ((dstvector)->array != NULL && (dstvector)->allocated_slots > 0)  \
+            _ret = VEC_ALREADY_INITIALIZED; \
+        else {\
+            (dstvector)->element_size = mapped_ele_size; \
+            (dstvector)->used_slots = (srcvector)->used_slots;\
+            (dstvector)->allocated_slots = (srcvector)->allocated_slots;\
+            (dstvector)->array = vec_mem_alloc((dstvector)->allocator, (size_t)(srcvector)->allocated_slots * (mapped_ele_size));\
+            if ((dstvector)->array == NULL) \
+                _ret = VEC_COULD_NOT_ALLOCATE_MEMORY; \
+            else { \
+                for (_i = 0; _i < (srcvector)->used_slots; _i++) {\
+                    src_element_ptr = (srcvector)->array + _i * (srcvector)->element_size; \
+                    dst_element_ptr = (dstvector)->array + _i * (dstvector)->element_size; \
+                    expression\
+                }\
+            } \
+        }\
+        _ret;\
+})
 #endif
 
 
@@ -308,9 +951,11 @@ int to_array(vec_t * vec, void ** resultptr);
  * vector is a vec_t *, element_buffer is a x *, where x is the type being stored.
  * expression is any code you choose to execute, that will have the variable *exlement_buffer
  * availible and filled out with a given element.  break will work to end early.
+ * Rebuilds the vector's index, if it has one, afterwards.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY if the index could not be rebuilt
  */
 #define VEC_ITER(vector, element_buffer, expression) ({\
         int _ret = VEC_SUCCESS;\
@@ -320,6 +965,33 @@ int to_array(vec_t * vec, void ** resultptr);
             expression;\
             memcpy((vector)->array + _i * (vector)->element_size, element_buffer,(vector)->element_size);\
         }\
+        /* the copies written back may have changed the elements */\
+        _ret = VEC_INDEX_REFRESH(vector);\
+        _ret;\
+})
+
+/**
+ * same as VEC_ITER, but element_ptr is a x * variable that is pointed at each element
+ * in turn instead of a buffer that gets filled out and copied back.  Changes made
+ * through element_ptr go straight into the vector.  break will work to end early.
+ * Do not add or remove elements from inside the expression.
+ *
+ * Example:
+ *      struct x * ptr;
+ *      VEC_ITER_PTR(vector, ptr, ptr->z += 1;)
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ */
+#define VEC_ITER_PTR(vector, element_ptr, expression) ({\
+        int _ret = VEC_SUCCESS;\
+        unsigned int _i;\
+        for (_i = 0; _i < (vector)->used_slots; _i++) {\
+            element_ptr = (vector)->array + _i * (vector)->element_size;\
+            expression;\
+        }\
+        /* the elements may have been changed in place */\
+        _ret = VEC_INDEX_REFRESH(vector);\
         _ret;\
 })
 
@@ -330,25 +1002,58 @@ int to_array(vec_t * vec, void ** resultptr);
  * last thing in the expression should be a boolean with no trailing semicolon.
  * vector is a sync_vec_t *, element_buffer is a x *, where x is the type being stored.
  * expression is any code you choose to execute, that will have the variable *exlement_buffer
- * availible and filled out with a given element.  break will work to end early.
+ * availible and filled out with a given element.  break will work to end early,
+ * keeping the current element and everything after it unchanged.  Like VEC_FILTER
+ * this is a single pass that shrinks at most once at the end.
  *
  * possible results:
  *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
  */
 #define VEC_ITER_REMOVE(vector, element_buffer, expression) ({\
-        int _ret = VEC_SUCCESS;\
-        unsigned int _i;\
+        unsigned int _i, _keep = 0;\
+        size_t _es = (vector)->element_size;\
         for (_i = 0; _i < (vector)->used_slots; _i++) {\
-            memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size);\
-            if(expression){\
-                remove_index(vector, _i); \
-                _i--;\
+            memcpy(element_buffer, (vector)->array + _i * _es, _es);\
+            if(!(expression)){\
+                memcpy((vector)->array + _keep * _es, element_buffer, _es);\
+                _keep++;\
             }\
-            else {\
-                memcpy((vector)->array + _i * (vector)->element_size, element_buffer,(vector)->element_size);\
+        }\
+        _VEC_COMPACT_FINISH(vector, _i, _keep);\
+})
+
+/**
+ * same as VEC_ITER_REMOVE, but does not keep the order of the vector. Every removed
+ * element is replaced by the last element not visited yet, which is visited next, so
+ * only one element moves per removal instead of every kept element sliding down.
+ * Elements the expression keeps are copied back in place. break ends early, keeping
+ * the current element and every element not visited yet. Do not use continue.
+ * Shrinks at most once at the end, and rebuilds the index, if any, like VEC_ITER_REMOVE.
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY
+ */
+#define VEC_ITER_SWAP_REMOVE(vector, element_buffer, expression) ({\
+        int _res;\
+        unsigned int _i = 0, _end = (vector)->used_slots;\
+        size_t _es = (vector)->element_size;\
+        while (_i < _end) {\
+            memcpy(element_buffer, (vector)->array + _i * _es, _es);\
+            if(expression){\
+                _end--;\
+                memcpy((vector)->array + _i * _es, (vector)->array + _end * _es, _es);\
+            } else {\
+                memcpy((vector)->array + _i * _es, element_buffer, _es);\
+                _i++;\
             }\
         }\
-        _ret;\
+        /* everything from _end on was removed */\
+        _res = vec_truncate(vector, _end);\
+        if (_res == VEC_SUCCESS)\
+            _res = VEC_INDEX_REFRESH(vector);\
+        _res;\
 })
 
 /**
@@ -366,10 +1071,37 @@ int to_array(vec_t * vec, void ** resultptr);
             for (_i = 0; _i < (vector)->used_slots; _i++) { \
                 memcpy(element_buffer, (vector)->array + _i * (vector)->element_size, (vector)->element_size); \
                 if (condition) { \
-                    _ret = VEC_SUCCESS; \
-                    memcpy((vector)->array + _i * (vector)->element_size, element, (vector)->element_size);\
+                    _ret = replace(vector, element, _i); \
                     break; \
                 } \
         } \
         _ret; \
 })
+
+/**
+ * sorts the vector in place with an introsort generated for the element type T,
+ * so every comparison is inlined instead of going through a cmpfn like sort does.
+ * vector is a vec_t *. a and b are names for two T * variables the macro declares,
+ * and less_expr is a boolean expression that is true when *a belongs before *b.
+ * See sort/sort_by.h for how it works.  Not stable.
+ *
+ * Example:
+ *      struct x {
+ *          int y;
+ *          int z;
+ *      }
+ *
+ *      VEC_SORT_BY(vector, struct x, a, b, a->y < b->y);
+ *
+ * possible results:
+ *  VEC_SUCCESS
+ *  VEC_INVALID_ARGUMENT if sizeof(T) is not the vector's element size
+ */
+#define VEC_SORT_BY(vector, T, a, b, less_expr) ({\
+        int _ret = VEC_INVALID_ARGUMENT;\
+        if (sizeof(T) == (vector)->element_size) {\
+            VEC_SORT_ARRAY_BY(T, (T *)(vector)->array, (vector)->used_slots, a, b, less_expr);\
+            _ret = VEC_INDEX_REFRESH(vector);\
+        }\
+        _ret;\
+})
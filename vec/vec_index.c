@@ -0,0 +1,395 @@
+#include <stdlib.h>
+#include <string.h>
+#include "vec.h"
+
+#define MIN_CAPACITY 64
+#define EMPTY UINT32_MAX
+
+/*
+ * an open addressing table with linear probing, kept at most half full so probe
+ * sequences stay short. Every element of the vector has an entry holding its
+ * position and the hash of its key, duplicates included. The hash is kept so the
+ * table can grow and probe without reading the elements. The table always comes
+ * from the system allocator, the vector's allocator may be a file mapping.
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t pos;
+} entry_t;
+
+typedef struct {
+    //must be first, vector->index points here
+    struct vec_index hooks;
+    size_t key_offset;
+    size_t key_size;
+    entry_t * entries;
+    size_t capacity;
+    size_t count;
+} hash_index_t;
+
+static inline hash_index_t * get_index(vec_t * vector) {
+    return (hash_index_t *)vector->index;
+}
+
+static inline uint32_t hash_key(const void * key, size_t size) {
+    const unsigned char * p = key;
+    uint32_t k32;
+    uint64_t h;
+    size_t i;
+
+    if (size == 4) {
+        memcpy(&k32, key, 4);
+        h = k32;
+    } else if (size == 8) {
+        memcpy(&h, key, 8);
+    } else {
+        //fnv-1a for anything else
+        h = 14695981039346656037ull;
+        for (i = 0; i < size; i++)
+            h = (h ^ p[i]) * 1099511628211ull;
+    }
+
+    //mix every bit into the low ones the table uses
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+
+    return (uint32_t)h;
+}
+
+static inline void * element_at(vec_t * vector, uint32_t pos) {
+    return vector->array + (size_t)pos * vector->element_size;
+}
+
+static inline uint32_t hash_element(hash_index_t * index, const void * element) {
+    return hash_key(element + index->key_offset, index->key_size);
+}
+
+static void put(hash_index_t * index, uint32_t hash, uint32_t pos) {
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+
+    while (index->entries[i].pos != EMPTY)
+        i = (i + 1) & mask;
+
+    index->entries[i].hash = hash;
+    index->entries[i].pos = pos;
+    index->count++;
+}
+
+//the entry for position pos with the given hash. NULL only if the element was
+//changed behind the index's back without a vec_index_rebuild
+static entry_t * entry_of(hash_index_t * index, uint32_t hash, uint32_t pos) {
+    size_t mask = index->capacity - 1;
+    size_t i;
+
+    for (i = hash & mask; index->entries[i].pos != EMPTY; i = (i + 1) & mask)
+        if (index->entries[i].pos == pos && index->entries[i].hash == hash)
+            return &index->entries[i];
+
+    return NULL;
+}
+
+//removes entry e, moving later entries of the probe sequence back into the hole
+static void take(hash_index_t * index, entry_t * e) {
+    size_t mask = index->capacity - 1;
+    size_t i, j, home;
+
+    if (e == NULL)
+        return;
+    i = j = e - index->entries;
+
+    while (1) {
+        j = (j + 1) & mask;
+        if (index->entries[j].pos == EMPTY)
+            break;
+        home = index->entries[j].hash & mask;
+        //the entry at j can fill the hole at i only if its home is not in (i, j]
+        if ((j > i && (home <= i || home > j)) || (j < i && home <= i && home > j)) {
+            index->entries[i] = index->entries[j];
+            i = j;
+        }
+    }
+
+    index->entries[i].pos = EMPTY;
+    index->count--;
+}
+
+static int resize_table(vec_t * vector, size_t capacity) {
+    hash_index_t * index = get_index(vector);
+    entry_t * old = index->entries;
+    size_t old_capacity = index->capacity;
+    size_t i;
+
+    index->entries = vec_mem_alloc(NULL, capacity * sizeof(entry_t));
+    if (index->entries == NULL) {
+        index->entries = old;
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
+    memset(index->entries, 0xff, capacity * sizeof(entry_t));
+    index->capacity = capacity;
+    index->count = 0;
+
+    for (i = 0; i < old_capacity; i++)
+        if (old[i].pos != EMPTY)
+            put(index, old[i].hash, old[i].pos);
+
+    vec_mem_free(NULL, old, old_capacity * sizeof(entry_t));
+
+    return VEC_SUCCESS;
+}
+
+//makes sure count entries fit while keeping the table at most half full
+static int reserve_table(vec_t * vector, size_t count) {
+    size_t capacity = get_index(vector)->capacity;
+
+    if (count <= capacity / 2)
+        return VEC_SUCCESS;
+
+    while (count > capacity / 2)
+        capacity *= 2;
+
+    return resize_table(vector, capacity);
+}
+
+/*
+ * moves the entries for positions [begin, end) by delta. A short run is fixed up
+ * one element at a time through its hash, a long one by a pass over the table.
+ * Elements are visited in the order that never leaves two entries with the
+ * same position and hash.
+ */
+static void shift(vec_t * vector, uint32_t begin, uint32_t end, int64_t delta) {
+    hash_index_t * index = get_index(vector);
+    entry_t * e;
+    uint32_t pos, n;
+    size_t i;
+
+    if (begin >= end)
+        return;
+
+    if ((size_t)(end - begin) * 4 < index->capacity) {
+        for (n = 0; n < end - begin; n++) {
+            pos = delta > 0 ? end - 1 - n : begin + n;
+            e = entry_of(index, hash_element(index, element_at(vector, pos)), pos);
+            if (e != NULL)
+                e->pos += delta;
+        }
+        return;
+    }
+
+    for (i = 0; i < index->capacity; i++)
+        if (index->entries[i].pos != EMPTY && index->entries[i].pos >= begin && index->entries[i].pos < end)
+            index->entries[i].pos += delta;
+}
+
+static int index_inserting(vec_t * vector, void * elements, uint32_t idx, uint32_t count) {
+    hash_index_t * index = get_index(vector);
+    uint32_t i;
+    int res;
+
+    if ((res = reserve_table(vector, index->count + count)))
+        return res;
+
+    //make room first, so the new positions are free
+    shift(vector, idx, vector->used_slots, count);
+
+    for (i = 0; i < count; i++)
+        put(index, hash_element(index, elements + (size_t)i * vector->element_size), idx + i);
+
+    return VEC_SUCCESS;
+}
+
+static void index_removing(vec_t * vector, uint32_t idx, uint32_t count) {
+    hash_index_t * index = get_index(vector);
+    uint32_t pos;
+
+    for (pos = idx; pos < idx + count; pos++)
+        take(index, entry_of(index, hash_element(index, element_at(vector, pos)), pos));
+
+    shift(vector, idx + count, vector->used_slots, -(int64_t)count);
+}
+
+static void index_swap_removing(vec_t * vector, uint32_t idx) {
+    hash_index_t * index = get_index(vector);
+    uint32_t last = vector->used_slots - 1;
+    entry_t * e;
+
+    take(index, entry_of(index, hash_element(index, element_at(vector, idx)), idx));
+
+    //only the last element moves, into the hole
+    if (idx != last) {
+        e = entry_of(index, hash_element(index, element_at(vector, last)), last);
+        if (e != NULL)
+            e->pos = idx;
+    }
+}
+
+static void index_replacing(vec_t * vector, void * element_ptr, uint32_t idx) {
+    hash_index_t * index = get_index(vector);
+
+    take(index, entry_of(index, hash_element(index, element_at(vector, idx)), idx));
+    put(index, hash_element(index, element_ptr), idx);
+}
+
+static int index_rebuild(vec_t * vector) {
+    hash_index_t * index = get_index(vector);
+    uint32_t pos;
+    int res;
+
+    memset(index->entries, 0xff, index->capacity * sizeof(entry_t));
+    index->count = 0;
+
+    if ((res = reserve_table(vector, vector->used_slots)))
+        return res;
+
+    for (pos = 0; pos < vector->used_slots; pos++)
+        put(index, hash_element(index, element_at(vector, pos)), pos);
+
+    return VEC_SUCCESS;
+}
+
+/*
+ * the first position whose key matches key. With whole set the entire element must
+ * match element, not just the key. Every entry of the probe sequence has to be
+ * looked at, since equal keys are not stored in position order.
+ */
+static int lookup(vec_t * vector, const void * key, const void * element, uint32_t * idx) {
+    hash_index_t * index = get_index(vector);
+    size_t mask = index->capacity - 1;
+    uint32_t hash = hash_key(key, index->key_size);
+    uint32_t best = EMPTY;
+    size_t i;
+    entry_t * e;
+
+    for (i = hash & mask; index->entries[i].pos != EMPTY; i = (i + 1) & mask) {
+        e = &index->entries[i];
+        if (e->hash != hash || e->pos >= best)
+            continue;
+        if (memcmp(element_at(vector, e->pos) + index->key_offset, key, index->key_size) != 0)
+            continue;
+        if (element != NULL && memcmp(element_at(vector, e->pos), element, vector->element_size) != 0)
+            continue;
+        best = e->pos;
+    }
+
+    if (best == EMPTY)
+        return VEC_NOT_FOUND;
+
+    *idx = best;
+    return VEC_SUCCESS;
+}
+
+static int index_find_element(vec_t * vector, void * element_ptr, uint32_t * idx) {
+    hash_index_t * index = get_index(vector);
+    return lookup(vector, element_ptr + index->key_offset, element_ptr, idx);
+}
+
+static void index_destroy(vec_t * vector) {
+    hash_index_t * index = get_index(vector);
+
+    vec_mem_free(NULL, index->entries, index->capacity * sizeof(entry_t));
+    vec_mem_free(NULL, index, sizeof(hash_index_t));
+    vector->index = NULL;
+}
+
+int vec_index_enable(vec_t * vector, size_t key_offset, size_t key_size) {
+    hash_index_t * index;
+    int res;
+
+    if (vector->index != NULL)
+        return VEC_ALREADY_INITIALIZED;
+
+    if (key_size == 0) {
+        key_offset = 0;
+        key_size = vector->element_size;
+    }
+    if (key_offset + key_size > vector->element_size)
+        return VEC_INVALID_ARGUMENT;
+
+    index = vec_mem_alloc(NULL, sizeof(hash_index_t));
+    if (index == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    index->hooks.inserting = index_inserting;
+    index->hooks.removing = index_removing;
+    index->hooks.swap_removing = index_swap_removing;
+    index->hooks.replacing = index_replacing;
+    index->hooks.rebuild = index_rebuild;
+    index->hooks.find_element = index_find_element;
+    index->hooks.destroy = index_destroy;
+    index->key_offset = key_offset;
+    index->key_size = key_size;
+    index->capacity = MIN_CAPACITY;
+    index->count = 0;
+    index->entries = vec_mem_alloc(NULL, MIN_CAPACITY * sizeof(entry_t));
+    if (index->entries == NULL) {
+        vec_mem_free(NULL, index, sizeof(hash_index_t));
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+    }
+
+    vector->index = &index->hooks;
+
+    if ((res = index_rebuild(vector)))
+        index_destroy(vector);
+
+    return res;
+}
+
+int vec_index_disable(vec_t * vector) {
+    if (vector->index == NULL)
+        return VEC_NOT_FOUND;
+
+    vector->index->destroy(vector);
+    return VEC_SUCCESS;
+}
+
+int vec_index_rebuild(vec_t * vector) {
+    if (vector->index == NULL)
+        return VEC_NOT_FOUND;
+
+    return vector->index->rebuild(vector);
+}
+
+int vec_find(vec_t * vector, void * element_ptr, int * idx) {
+    uint32_t i;
+    int res;
+
+    if (element_ptr == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    if (vector->index == NULL) {
+        for (i = 0; i < vector->used_slots; i++) {
+            if (memcmp(element_at(vector, i), element_ptr, vector->element_size) == 0) {
+                *idx = i;
+                return VEC_SUCCESS;
+            }
+        }
+        return VEC_NOT_FOUND;
+    }
+
+    if ((res = index_find_element(vector, element_ptr, &i)))
+        return res;
+
+    *idx = i;
+    return VEC_SUCCESS;
+}
+
+int vec_find_key(vec_t * vector, void * key, int * idx) {
+    uint32_t i;
+    int res;
+
+    if (key == NULL || idx == NULL)
+        return VEC_NULL_BUFFER;
+
+    //only the index knows where the key is, without it there is nothing to compare
+    if (vector->index == NULL)
+        return VEC_INVALID_ARGUMENT;
+
+    if ((res = lookup(vector, key, NULL, &i)))
+        return res;
+
+    *idx = i;
+    return VEC_SUCCESS;
+}
@@ -0,0 +1,67 @@
+#include <limits.h>
+#include "vec.h"
+#include "../io/vec_stream.h"
+
+int vec_save(vec_t * vector, int fd) {
+    vec_writer_t writer;
+    int res;
+
+    if (vector->array == NULL)
+        return VEC_NULL_BUFFER;
+
+    if ((res = vec_writer_open(&writer, fd, vector->element_size, vector->used_slots)))
+        return res;
+
+    //chunks are written straight out of the array, no copy is ever made
+    if ((res = vec_writer_write(&writer, vector->array, vector->used_slots)))
+        return res;
+
+    return vec_writer_close(&writer);
+}
+
+int vec_load(vec_t * vector, int fd) {
+    const vec_allocator_t * allocator;
+    vec_reader_t reader;
+    uint32_t count;
+    int res;
+
+    //check already initialized
+    if (vector->array != NULL && vector->allocated_slots > 0) 
+        return VEC_ALREADY_INITIALIZED;
+
+    if ((res = vec_reader_open(&reader, fd)))
+        return res;
+
+    if (reader.count_hint > INT_MAX)
+        return VEC_BAD_FORMAT;
+
+    //the hint lets a well formed stream load with a single allocation
+    if ((res = init_with_capacity(vector, reader.element_size, (int)reader.count_hint)))
+        return res;
+
+    while (1) {
+        if ((res = vec_reader_next_chunk(&reader, &count)))
+            break;
+        if (count == 0)
+            return VEC_SUCCESS;
+
+        if ((uint64_t)vector->used_slots + count > INT_MAX) {
+            res = VEC_BAD_FORMAT;
+            break;
+        }
+        if ((res = reserve(vector, vector->used_slots + count)))
+            break;
+
+        //read the chunk right into its place in the array
+        if ((res = vec_reader_read_chunk(&reader, vector->array + vector->used_slots * vector->element_size)))
+            break;
+        vector->used_slots += count;
+    }
+
+    //leave the vector as it was handed in, allocator included
+    allocator = vector->allocator;
+    destroy(vector);
+    vector->allocator = allocator;
+
+    return res;
+}
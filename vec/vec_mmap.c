@@ -0,0 +1,208 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "vec.h"
+
+#define MIN_SIZE 64
+#define MAGIC "CVECMAP"
+#define VERSION 1
+
+//the header takes a whole cache line so the elements start nicely aligned
+#define HEADER_SIZE 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t element_size;
+    uint64_t used_slots;
+    uint64_t allocated_slots;
+} mmap_header_t;
+
+typedef struct {
+    vec_allocator_t allocator;
+    int fd;
+    unsigned char * base;
+    size_t map_size;
+} mmap_ctx_t;
+
+//resizes the file and the mapping to hold size bytes of elements
+static int remap(mmap_ctx_t * ctx, size_t size) {
+    size_t map_size = HEADER_SIZE + size;
+    void * base;
+
+    //touching a mapping past the end of its file raises SIGBUS, so the file has to
+    //cover the mapping at all times: grow the file first, and shrink it last
+    if (map_size > ctx->map_size && ftruncate(ctx->fd, map_size))
+        return VEC_IO_ERROR;
+
+    if (ctx->base == NULL)
+        base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->fd, 0);
+    else {
+#ifdef MREMAP_MAYMOVE
+        base = mremap(ctx->base, ctx->map_size, map_size, MREMAP_MAYMOVE);
+#else
+        munmap(ctx->base, ctx->map_size);
+        ctx->base = NULL;
+        ctx->map_size = 0;
+        base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->fd, 0);
+#endif
+    }
+
+    if (base == MAP_FAILED)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    //the mapping already changed, so a file that stays too long is left as it is;
+    //the extra bytes are harmless and the header says how many slots are in use
+    if (map_size < ctx->map_size)
+        (void)!ftruncate(ctx->fd, map_size);
+
+    ctx->base = base;
+    ctx->map_size = map_size;
+
+    return VEC_SUCCESS;
+}
+
+static void * mmap_alloc(void * ctx, size_t size) {
+    mmap_ctx_t * mctx = ctx;
+
+    //the file only holds one array
+    if (mctx->base != NULL || remap(mctx, size))
+        return NULL;
+
+    return mctx->base + HEADER_SIZE;
+}
+
+static void * mmap_realloc(void * ctx, void * ptr, size_t old_size, size_t new_size) {
+    mmap_ctx_t * mctx = ctx;
+    (void)ptr;
+    (void)old_size;
+
+    if (remap(mctx, new_size))
+        return NULL;
+
+    return mctx->base + HEADER_SIZE;
+}
+
+static void mmap_free(void * ctx, void * ptr, size_t size) {
+    mmap_ctx_t * mctx = ctx;
+    (void)ptr;
+    (void)size;
+
+    if (mctx->base != NULL)
+        munmap(mctx->base, mctx->map_size);
+    close(mctx->fd);
+    free(mctx);
+}
+
+static mmap_ctx_t * get_ctx(vec_t * vector) {
+    if (vector->allocator == NULL || vector->allocator->alloc_fn != mmap_alloc)
+        return NULL;
+
+    return vector->allocator->ctx;
+}
+
+int vec_open_mmap(vec_t * vector, const char * path, size_t element_size) {
+    mmap_header_t header;
+    mmap_ctx_t * ctx;
+    struct stat st;
+    int res;
+
+    //check already initialized
+    if (vector->array != NULL && vector->allocated_slots > 0) 
+        return VEC_ALREADY_INITIALIZED;
+
+    ctx = calloc(1, sizeof(mmap_ctx_t));
+    if (ctx == NULL)
+        return VEC_COULD_NOT_ALLOCATE_MEMORY;
+
+    ctx->allocator.alloc_fn = mmap_alloc;
+    ctx->allocator.realloc_fn = mmap_realloc;
+    ctx->allocator.free_fn = mmap_free;
+    ctx->allocator.ctx = ctx;
+
+    ctx->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (ctx->fd < 0) {
+        free(ctx);
+        return VEC_IO_ERROR;
+    }
+
+    if (fstat(ctx->fd, &st)) {
+        res = VEC_IO_ERROR;
+        goto fail;
+    }
+
+    if (st.st_size == 0) {
+        //brand new file, start out like init would
+        memset(&header, 0, sizeof(mmap_header_t));
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.element_size = element_size;
+        header.allocated_slots = MIN_SIZE;
+    }
+    else {
+        if (st.st_size < HEADER_SIZE
+                || pread(ctx->fd, &header, sizeof(mmap_header_t), 0) != sizeof(mmap_header_t)
+                || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+                || header.version != VERSION
+                || header.element_size != element_size
+                || header.allocated_slots == 0
+                || header.used_slots > header.allocated_slots
+                || header.allocated_slots > UINT32_MAX
+                || (uint64_t)st.st_size < HEADER_SIZE + header.allocated_slots * element_size) {
+            res = VEC_BAD_FORMAT;
+            goto fail;
+        }
+    }
+
+    res = remap(ctx, header.allocated_slots * element_size);
+    if (res)
+        goto fail;
+    memcpy(ctx->base, &header, sizeof(mmap_header_t));
+
+    vector->element_size = element_size;
+    vector->used_slots = header.used_slots;
+    vector->allocated_slots = header.allocated_slots;
+    vector->array = ctx->base + HEADER_SIZE;
+    vector->allocator = &ctx->allocator;
+
+    return VEC_SUCCESS;
+
+fail:
+    close(ctx->fd);
+    free(ctx);
+    return res;
+}
+
+int vec_flush_mmap(vec_t * vector) {
+    mmap_ctx_t * ctx = get_ctx(vector);
+    mmap_header_t * header;
+
+    if (ctx == NULL)
+        return VEC_INVALID_ARGUMENT;
+
+    header = (mmap_header_t *)ctx->base;
+    header->used_slots = vector->used_slots;
+    header->allocated_slots = vector->allocated_slots;
+
+    if (msync(ctx->base, ctx->map_size, MS_SYNC))
+        return VEC_IO_ERROR;
+
+    return VEC_SUCCESS;
+}
+
+int vec_close_mmap(vec_t * vector) {
+    int res = vec_flush_mmap(vector);
+
+    if (res == VEC_INVALID_ARGUMENT)
+        return res;
+
+    //unmap and close even if the flush failed, there is nothing better to do
+    destroy(vector);
+
+    return res;
+}
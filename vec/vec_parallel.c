@@ -0,0 +1,36 @@
+#include "vec.h"
+#include "../par/vec_par.h"
+
+int vec_parallel_map(vec_t * src, vec_t * dst, size_t dst_element_size, vec_map_fn fn, void * ctx) {
+    int res;
+
+    if ((res = init_with_capacity(dst, dst_element_size, src->used_slots)))
+        return res;
+
+    vec_par_map(src->array, src->used_slots, src->element_size, dst->array, dst_element_size, fn, ctx);
+    dst->used_slots = src->used_slots;
+
+    return VEC_INDEX_REFRESH(dst);
+}
+
+int vec_parallel_filter(vec_t * vector, vec_pred_fn pred, void * ctx) {
+    size_t kept;
+    int res;
+
+    if ((res = vec_par_filter(vector->array, vector->used_slots, vector->element_size, pred, ctx, &kept)))
+        return res;
+
+    if ((res = vec_truncate(vector, kept)))
+        return res;
+
+    return VEC_INDEX_REFRESH(vector);
+}
+
+int vec_parallel_reduce(vec_t * vector, void * result, size_t result_size,
+        vec_reduce_fn fn, vec_combine_fn combine, void * ctx) {
+    if (result == NULL)
+        return VEC_NULL_BUFFER;
+
+    return vec_par_reduce(vector->array, vector->used_slots, vector->element_size,
+            result, result_size, fn, combine, ctx);
+}
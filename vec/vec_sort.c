@@ -0,0 +1,16 @@
+#include "vec.h"
+#include "../sort/psort.h"
+#include "../sort/radix.h"
+
+int parallel_sort(vec_t * vector, cmpfn cmp, int nthreads) {
+    //scratch space comes from the system, the vector's allocator may only hold its array
+    int res = vec_psort(vector->array, vector->used_slots, vector->element_size, cmp, nthreads, NULL);
+    return res ? res : VEC_INDEX_REFRESH(vector);
+}
+
+int radix_sort(vec_t * vector, size_t key_offset, size_t key_width, int flags) {
+    //scratch space comes from the system, like parallel_sort's
+    int res = vec_radix_sort(vector->array, vector->used_slots, vector->element_size,
+            key_offset, key_width, flags, NULL);
+    return res ? res : VEC_INDEX_REFRESH(vector);
+}
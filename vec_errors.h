@@ -0,0 +1,29 @@
+#ifndef VEC_ERRORS_H
+
+#define VEC_ERRORS_H
+
+/**
+ * the return values shared by every vector type and helper in the library.
+ * Each header includes this one, so a code means the same thing everywhere.
+ *  VEC_SUCCESS:                   the call did what it was asked
+ *  VEC_INDEX_OUT_OF_BOUNDS:       an index or length is outside the vector
+ *  VEC_COULD_NOT_ALLOCATE_MEMORY: the allocator failed, or the size would overflow
+ *  VEC_NOT_FOUND:                 no element matched
+ *  VEC_ALREADY_INITIALIZED:       the vector given to an init function is in use
+ *  VEC_ALREADY_DESTROYED:         the vector given to a destroy function holds nothing
+ *  VEC_NULL_BUFFER:               a required pointer argument is NULL
+ *  VEC_INVALID_ARGUMENT:          an argument is out of its allowed range
+ *  VEC_IO_ERROR:                  reading or writing a file failed
+ *  VEC_BAD_FORMAT:                a file or stream is not what it should be
+ */
+#define VEC_SUCCESS 0
+#define VEC_INDEX_OUT_OF_BOUNDS 1
+#define VEC_COULD_NOT_ALLOCATE_MEMORY 2
+#define VEC_NOT_FOUND 3
+#define VEC_ALREADY_INITIALIZED 4
+#define VEC_ALREADY_DESTROYED 5
+#define VEC_NULL_BUFFER 6
+#define VEC_INVALID_ARGUMENT 7
+#define VEC_IO_ERROR 8
+#define VEC_BAD_FORMAT 9
+#endif
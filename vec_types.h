@@ -0,0 +1,38 @@
+#ifndef VEC_TYPES_H
+
+#define VEC_TYPES_H
+
+#include <stdint.h>
+
+/**
+ * controls how a vector grows and shrinks. zeroed fields fall back to the defaults:
+ *  growth_factor:  multiplier applied to the allocation when the vector is full (default 2.0)
+ *  shrink_divisor: shrink once fewer than 1/shrink_divisor of the slots are in use (default 4).
+ *                  must be larger than growth_factor. On shrink the allocation becomes
+ *                  used_slots * growth_factor so the vector does not thrash around the threshold
+ *  flags:          VEC_NEVER_SHRINK to keep the allocation no matter how much is removed
+ */
+typedef struct {
+    float growth_factor;
+    uint32_t shrink_divisor;
+    uint32_t flags;
+} vec_policy_t;
+
+#define VEC_NEVER_SHRINK 1
+#define VEC_DEFAULT_POLICY {2.0f, 4, 0}
+
+/**
+ * flags for vec_radix_sort, radix_sort and sync_radix_sort. Keys are unsigned
+ * unless VEC_RADIX_SIGNED is given, in which case they are two's complement.
+ */
+#define VEC_RADIX_UNSIGNED 0
+#define VEC_RADIX_SIGNED 1
+
+typedef int (*cmpfn)(const void*,const void*);
+
+//callbacks for the parallel map, filter and reduce
+typedef void (*vec_map_fn)(const void * src_element, void * dst_element, void * ctx);
+typedef int (*vec_pred_fn)(const void * element, void * ctx);
+typedef void (*vec_reduce_fn)(void * acc, const void * element, void * ctx);
+typedef void (*vec_combine_fn)(void * acc, const void * other, void * ctx);
+#endif